@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "6502.h"
+#include "decode.h"
 #include "output.h"
 #include "input.h"
 #include "memory.h"
@@ -44,284 +45,456 @@ typedef struct
 {
     const char  *text;
     argument_t  argtype;
+    int         illegal;
+    flow_t      flow;
 } opcode_t;
 
 static opcode_t optable[256] =
 {
-    {/* 00 */   "brk",                  eImplied},
-    {/* 01 */   "ora ($%2.2x,x)",       eByte},
-    {/* 02 */   "jam",                  eImplied},
-    {/* 03 */   "slo ($%2.2x,x)",       eByte},
-    {/* 04 */   "nop $%2.2x",           eByte},
-    {/* 05 */   "ora $%2.2x",           eByte},
-    {/* 06 */   "asl $%2.2x",           eByte},
-    {/* 07 */   "slo $%2.2x",           eByte},
-    {/* 08 */   "php",                  eImplied},
-    {/* 09 */   "ora #$%2.2x",          eByte},
-    {/* 0a */   "asl a",                eImplied},
-    {/* 0b */   "anc #$%2.2x",          eByte},
-    {/* 0c */   "nop $%4.4x",           eWord},
-    {/* 0d */   "ora $%4.4x",           eWord},
-    {/* 0e */   "asl $%4.4x",           eWord},
-    {/* 0f */   "slo $%4.4x",           eWord},
-
-    {/* 10 */   "bpl $%4.4x",           eRelative},
-    {/* 11 */   "ora ($%2.2x),y",       eByte},
-    {/* 12 */   "jam",                  eImplied},
-    {/* 13 */   "slo ($%2.2x),y",       eByte},
-    {/* 14 */   "nop $%2.2x,x",         eByte},
-    {/* 15 */   "ora $%2.2x,x",         eByte},
-    {/* 16 */   "asl $%2.2x,x",         eByte},
-    {/* 17 */   "slo $%2.2x,x",         eByte},
-    {/* 18 */   "clc",                  eImplied},
-    {/* 19 */   "ora $%4.4x,y",         eWord},
-    {/* 1a */   "nop",                  eImplied},
-    {/* 1b */   "slo $%4.4x,y",         eWord},
-    {/* 1c */   "nop $%4.4x,x",         eWord},
-    {/* 1d */   "ora $%4.4x,x",         eWord},
-    {/* 1e */   "asl $%4.4x,x",         eWord},
-    {/* 1f */   "slo $%4.4x,x",         eWord},
-
-    {/* 20 */   "jsr $%4.4x",           eWord},
-    {/* 21 */   "and ($%2.2x,x)",       eByte},
-    {/* 22 */   "jam",                  eImplied},
-    {/* 23 */   "rla ($%2.2x,x)",       eByte},
-    {/* 24 */   "bit $%2.2x",           eByte},
-    {/* 25 */   "and $%2.2x",           eByte},
-    {/* 26 */   "rol $%2.2x",           eByte},
-    {/* 27 */   "rla $%2.2x",           eByte},
-    {/* 28 */   "plp",                  eImplied},
-    {/* 29 */   "and #$%2.2x",          eByte},
-    {/* 2a */   "rol a",                eImplied},
-    {/* 2b */   "anc2 #$%2.2x",         eByte},
-    {/* 2c */   "bit $%4.4x",           eWord},
-    {/* 2d */   "and $%4.4x",           eWord},
-    {/* 2e */   "rol $%4.4x",           eWord},
-    {/* 2f */   "rla $%4.4x",           eWord},
-
-    {/* 30 */   "bmi $%4.4x",           eRelative},
-    {/* 31 */   "and ($%2.2x),y",       eByte},
-    {/* 32 */   "jam",                  eImplied},
-    {/* 33 */   "rla ($%2.2x),y",       eByte},
-    {/* 34 */   "nop $%2.2x,x",         eByte},
-    {/* 35 */   "and $%2.2x,x",         eByte},
-    {/* 36 */   "rol $%2.2x,x",         eByte},
-    {/* 37 */   "rla $%2.2x,x",         eByte},
-    {/* 38 */   "sec",                  eImplied},
-    {/* 39 */   "and $%4.4x,y",         eWord},
-    {/* 3a */   "nop",                  eImplied},
-    {/* 3b */   "rla $%4.4x,y",         eWord},
-    {/* 3c */   "nop $%4.4x,x",         eWord},
-    {/* 3d */   "and $%4.4x,x",         eWord},
-    {/* 3e */   "rol $%4.4x,x",         eWord},
-    {/* 3f */   "rla $%4.4x,x",         eWord},
-
-    {/* 40 */   "rti",                  eImplied},
-    {/* 41 */   "eor ($%2.2x,x)",       eByte},
-    {/* 42 */   "jam",                  eImplied},
-    {/* 43 */   "sre ($%2.2x,x)",       eByte},
-    {/* 44 */   "nop $%2.2x",           eByte},
-    {/* 45 */   "eor $%2.2x",           eByte},
-    {/* 46 */   "lsr $%2.2x",           eByte},
-    {/* 47 */   "sre $%2.2x",           eByte},
-    {/* 48 */   "pha",                  eImplied},
-    {/* 49 */   "eor #$%2.2x",          eByte},
-    {/* 4a */   "lsr a",                eImplied},
-    {/* 4b */   "alr #$%2.2x",          eByte},
-    {/* 4c */   "jmp $%4.4x",           eWord},
-    {/* 4d */   "eor $%4.4x",           eWord},
-    {/* 4e */   "lsr $%4.4x",           eWord},
-    {/* 4f */   "sre $%4.4x",           eWord},
-
-    {/* 50 */   "bvc $%4.4x",           eRelative},
-    {/* 51 */   "eor ($%2.2x),y",       eByte},
-    {/* 52 */   "jam",                  eImplied},
-    {/* 53 */   "sre ($%2.2x),y",       eByte},
-    {/* 54 */   "nop $%2.2x,x",         eByte},
-    {/* 55 */   "eor $%2.2x,x",         eByte},
-    {/* 56 */   "lsr $%2.2x,x",         eByte},
-    {/* 57 */   "sre $%2.2x,x",         eByte},
-    {/* 58 */   "cli",                  eImplied},
-    {/* 59 */   "eor $%4.4x,y",         eWord},
-    {/* 5a */   "nop",                  eImplied},
-    {/* 5b */   "sre $%4.4x,y",         eWord},
-    {/* 5c */   "nop $%4.4x,x",         eWord},
-    {/* 5d */   "eor $%4.4x,x",         eWord},
-    {/* 5e */   "lsr $%4.4x,x",         eWord},
-    {/* 5f */   "sre $%4.4x,x",         eWord},
-
-    {/* 60 */   "rts",                  eImplied},
-    {/* 61 */   "adc ($%2.2x,x)",       eByte},
-    {/* 62 */   "jam",                  eImplied},
-    {/* 63 */   "rra ($%2.2x,x)",       eByte},
-    {/* 64 */   "nop $%2.2x",           eByte},
-    {/* 65 */   "adc $%2.2x",           eByte},
-    {/* 66 */   "ror $%2.2x",           eByte},
-    {/* 67 */   "rra $%2.2x",           eByte},
-    {/* 68 */   "pla",                  eImplied},
-    {/* 69 */   "adc #$%2.2x",          eByte},
-    {/* 6a */   "ror a",                eImplied},
-    {/* 6b */   "arr #$%2.2x",          eByte},
-    {/* 6c */   "jmp ($%4.4x)",         eWord},
-    {/* 6d */   "adc $%4.4x",           eWord},
-    {/* 6e */   "ror $%4.4x",           eWord},
-    {/* 6f */   "rra $%4.4x",           eWord},
-
-    {/* 70 */   "bvs $%4.4x",           eRelative},
-    {/* 71 */   "adc ($%2.2x),y",       eByte},
-    {/* 72 */   "jam",                  eImplied},
-    {/* 73 */   "rra ($%2.2x),y",       eByte},
-    {/* 74 */   "nop $%2.2x,x",         eByte},
-    {/* 75 */   "adc $%2.2x,x",         eByte},
-    {/* 76 */   "ror $%2.2x,x",         eByte},
-    {/* 77 */   "rra $%2.2x,x",         eByte},
-    {/* 78 */   "sei",                  eImplied},
-    {/* 79 */   "adc $%4.4x,y",         eWord},
-    {/* 7a */   "nop",                  eImplied},
-    {/* 7b */   "rra $%4.4x,y",         eWord},
-    {/* 7c */   "nop $%4.4x,x",         eWord},
-    {/* 7d */   "adc $%4.4x,x",         eWord},
-    {/* 7e */   "ror $%4.4x,x",         eWord},
-    {/* 7f */   "rra $%4.4x,x",         eWord},
-
-    {/* 80 */   "nop #$%2.2x",          eByte},
-    {/* 81 */   "sta ($%2.2x,x)",       eByte},
-    {/* 82 */   "nop #$%2.2x",          eByte},
-    {/* 83 */   "sax ($%2.2x,x)",       eByte},
-    {/* 84 */   "sty $%2.2x",           eByte},
-    {/* 85 */   "sta $%2.2x",           eByte},
-    {/* 86 */   "stx $%2.2x",           eByte},
-    {/* 87 */   "sax $%2.2x",           eByte},
-    {/* 88 */   "dey",                  eImplied},
-    {/* 89 */   "nop #$%2.2x",          eByte},
-    {/* 8a */   "txa",                  eImplied},
-    {/* 8b */   "ane #$%2.2x",          eByte},
-    {/* 8c */   "sty $%4.4x",           eWord},
-    {/* 8d */   "sta $%4.4x",           eWord},
-    {/* 8e */   "stx $%4.4x",           eWord},
-    {/* 8f */   "sax $%4.4x",           eWord},
-
-    {/* 90 */   "bcc $%4.4x",           eRelative},
-    {/* 91 */   "sta ($%2.2x),y",       eByte},
-    {/* 92 */   "jam",                  eImplied},
-    {/* 93 */   "sha ($%2.2x),y",       eByte},
-    {/* 94 */   "sty $%2.2x,x",         eByte},
-    {/* 95 */   "sta $%2.2x,x",         eByte},
-    {/* 96 */   "stx $%2.2x,y",         eByte},
-    {/* 97 */   "sax $%2.2x,y",         eByte},
-    {/* 98 */   "tya",                  eImplied},
-    {/* 99 */   "sta $%4.4x,y",         eWord},
-    {/* 9a */   "txs",                  eImplied},
-    {/* 9b */   "tas $%4.4x,y",         eWord},
-    {/* 9c */   "shy $%4.4x,x",         eWord},
-    {/* 9d */   "sta $%4.4x,x",         eWord},
-    {/* 9e */   "shx $%4.4x,y",         eWord},
-    {/* 9f */   "sha $%4.4x,y",         eWord},
-
-    {/* a0 */   "ldy #$%2.2x",          eByte},
-    {/* a1 */   "lda ($%2.2x,x)",       eByte},
-    {/* a2 */   "ldx #$%2.2x",          eByte},
-    {/* a3 */   "lax ($%2.2x,x)",       eByte},
-    {/* a4 */   "ldy $%2.2x",           eByte},
-    {/* a5 */   "lda $%2.2x",           eByte},
-    {/* a6 */   "ldx $%2.2x",           eByte},
-    {/* a7 */   "lax $%2.2x",           eByte},
-    {/* a8 */   "tay",                  eImplied},
-    {/* a9 */   "lda #$%2.2x",          eByte},
-    {/* aa */   "tax",                  eImplied},
-    {/* ab */   "lxa #$%2.2x",          eByte},
-    {/* ac */   "ldy $%4.4x",           eWord},
-    {/* ad */   "lda $%4.4x",           eWord},
-    {/* ae */   "ldx $%4.4x",           eWord},
-    {/* af */   "lax $%4.4x",           eWord},
-
-    {/* b0 */   "bcs $%4.4x",           eRelative},
-    {/* b1 */   "lda ($%2.2x),y",       eByte},
-    {/* b2 */   "jam",                  eImplied},
-    {/* b3 */   "lax ($%2.2x),y",       eByte},
-    {/* b4 */   "ldy $%2.2x,x",         eByte},
-    {/* b5 */   "lda $%2.2x,x",         eByte},
-    {/* b6 */   "ldx $%2.2x,y",         eByte},
-    {/* b7 */   "lax $%2.2x,y",         eByte},
-    {/* b8 */   "clv",                  eImplied},
-    {/* b9 */   "lda $%4.4x,y",         eWord},
-    {/* ba */   "tsx",                  eImplied},
-    {/* bb */   "las $%4.4x,y",         eWord},
-    {/* bc */   "ldy $%4.4x,x",         eWord},
-    {/* bd */   "lda $%4.4x,x",         eWord},
-    {/* be */   "ldx $%4.4x,y",         eWord},
-    {/* bf */   "lax $%4.4x,y",         eWord},
-
-    {/* c0 */   "cpy #$%2.2x",          eByte},
-    {/* c1 */   "cmp ($%2.2x,x)",       eByte},
-    {/* c2 */   "nop #$%2.2x",          eByte},
-    {/* c3 */   "dcp ($%2.2x,x)",       eByte},
-    {/* c4 */   "cpy $%2.2x",           eByte},
-    {/* c5 */   "cmp $%2.2x",           eByte},
-    {/* c6 */   "dec $%2.2x",           eByte},
-    {/* c7 */   "dcp $%2.2x",           eByte},
-    {/* c8 */   "iny",                  eImplied},
-    {/* c9 */   "cmp #$%2.2x",          eByte},
-    {/* ca */   "dex",                  eImplied},
-    {/* cb */   "sbx #$%2.2x",          eByte},
-    {/* cc */   "cpy $%4.4x",           eWord},
-    {/* cd */   "cmp $%4.4x",           eWord},
-    {/* ce */   "dec $%4.4x",           eWord},
-    {/* cf */   "dcp $%4.4x",           eWord},
-
-    {/* d0 */   "bne $%4.4x",           eRelative},
-    {/* d1 */   "cmp ($%2.2x),y",       eByte},
-    {/* d2 */   "jam",                  eImplied},
-    {/* d3 */   "dcp ($%2.2x),y",       eByte},
-    {/* d4 */   "nop $%2.2x,x",         eByte},
-    {/* d5 */   "cmp $%2.2x,x",         eByte},
-    {/* d6 */   "dec $%2.2x,x",         eByte},
-    {/* d7 */   "dcp $%2.2x,x",         eByte},
-    {/* d8 */   "cld",                  eImplied},
-    {/* d9 */   "cmp $%4.4x,y",         eWord},
-    {/* da */   "nop",                  eImplied},
-    {/* db */   "dcp $%4.4x,y",         eWord},
-    {/* dc */   "nop $%4.4x,x",         eWord},
-    {/* dd */   "cmp $%4.4x,x",         eWord},
-    {/* de */   "dec $%4.4x,x",         eWord},
-    {/* df */   "dcp $%4.4x,x",         eWord},
-
-    {/* e0 */   "cpx #$%2.2x",          eByte},
-    {/* e1 */   "sbc ($%2.2x,x)",       eByte},
-    {/* e2 */   "nop #$%2.2x",          eByte},
-    {/* e3 */   "isc ($%2.2x,x)",       eByte},
-    {/* e4 */   "cpx $%2.2x",           eByte},
-    {/* e5 */   "sbc $%2.2x",           eByte},
-    {/* e6 */   "inc $%2.2x",           eByte},
-    {/* e7 */   "isc $%2.2x",           eByte},
-    {/* e8 */   "inx",                  eImplied},
-    {/* e9 */   "sbc #$%2.2x",          eByte},
-    {/* ea */   "nop",                  eImplied},
-    {/* eb */   "usbc #$%2.2x",         eByte},
-    {/* ec */   "cpx $%4.4x",           eWord},
-    {/* ed */   "sbc $%4.4x",           eWord},
-    {/* ee */   "inc $%4.4x",           eWord},
-    {/* ef */   "isc $%4.4x",           eWord},
-
-    {/* f0 */   "beq $%4.4x",           eRelative},
-    {/* f1 */   "sbc ($%2.2x),y",       eByte},
-    {/* f2 */   "jam",                  eImplied},
-    {/* f3 */   "isc ($%2.2x),y",       eByte},
-    {/* f4 */   "nop $%2.2x,x",         eByte},
-    {/* f5 */   "sbc $%2.2x,x",         eByte},
-    {/* f6 */   "inc $%2.2x,x",         eByte},
-    {/* f7 */   "isc $%2.2x,x",         eByte},
-    {/* f8 */   "sed",                  eImplied},
-    {/* f9 */   "sbc $%4.4x,y",         eWord},
-    {/* fa */   "nop",                  eImplied},
-    {/* fb */   "isc $%4.4x,y",         eWord},
-    {/* fc */   "nop $%4.4x,x",         eWord},
-    {/* fd */   "sbc $%4.4x,x",         eWord},
-    {/* fe */   "inc $%4.4x,x",         eWord},
-    {/* ff */   "isc $%4.4x,x",         eWord},
+    {/* 00 */   "brk",                  eImplied,     FALSE, eFlowCall},
+    {/* 01 */   "ora ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* 02 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 03 */   "slo ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* 04 */   "nop $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 05 */   "ora $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 06 */   "asl $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 07 */   "slo $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 08 */   "php",                  eImplied,     FALSE, eFlowNext},
+    {/* 09 */   "ora #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* 0a */   "asl a",                eImplied,     FALSE, eFlowNext},
+    {/* 0b */   "anc #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 0c */   "nop $%4.4x",           eWord,        TRUE,  eFlowNext},
+    {/* 0d */   "ora $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 0e */   "asl $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 0f */   "slo $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* 10 */   "bpl $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* 11 */   "ora ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* 12 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 13 */   "slo ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* 14 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 15 */   "ora $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 16 */   "asl $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 17 */   "slo $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 18 */   "clc",                  eImplied,     FALSE, eFlowNext},
+    {/* 19 */   "ora $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* 1a */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* 1b */   "slo $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 1c */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* 1d */   "ora $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 1e */   "asl $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 1f */   "slo $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+
+    {/* 20 */   "jsr $%4.4x",           eWord,        FALSE, eFlowCall},
+    {/* 21 */   "and ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* 22 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 23 */   "rla ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* 24 */   "bit $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 25 */   "and $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 26 */   "rol $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 27 */   "rla $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 28 */   "plp",                  eImplied,     FALSE, eFlowNext},
+    {/* 29 */   "and #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* 2a */   "rol a",                eImplied,     FALSE, eFlowNext},
+    {/* 2b */   "anc2 #$%2.2x",         eByte,        TRUE,  eFlowNext},
+    {/* 2c */   "bit $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 2d */   "and $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 2e */   "rol $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 2f */   "rla $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* 30 */   "bmi $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* 31 */   "and ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* 32 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 33 */   "rla ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* 34 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 35 */   "and $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 36 */   "rol $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 37 */   "rla $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 38 */   "sec",                  eImplied,     FALSE, eFlowNext},
+    {/* 39 */   "and $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* 3a */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* 3b */   "rla $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 3c */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* 3d */   "and $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 3e */   "rol $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 3f */   "rla $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+
+    {/* 40 */   "rti",                  eImplied,     FALSE, eFlowReturn},
+    {/* 41 */   "eor ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* 42 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 43 */   "sre ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* 44 */   "nop $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 45 */   "eor $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 46 */   "lsr $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 47 */   "sre $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 48 */   "pha",                  eImplied,     FALSE, eFlowNext},
+    {/* 49 */   "eor #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* 4a */   "lsr a",                eImplied,     FALSE, eFlowNext},
+    {/* 4b */   "alr #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 4c */   "jmp $%4.4x",           eWord,        FALSE, eFlowJump},
+    {/* 4d */   "eor $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 4e */   "lsr $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 4f */   "sre $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* 50 */   "bvc $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* 51 */   "eor ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* 52 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 53 */   "sre ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* 54 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 55 */   "eor $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 56 */   "lsr $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 57 */   "sre $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 58 */   "cli",                  eImplied,     FALSE, eFlowNext},
+    {/* 59 */   "eor $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* 5a */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* 5b */   "sre $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 5c */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* 5d */   "eor $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 5e */   "lsr $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 5f */   "sre $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+
+    {/* 60 */   "rts",                  eImplied,     FALSE, eFlowReturn},
+    {/* 61 */   "adc ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* 62 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 63 */   "rra ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* 64 */   "nop $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 65 */   "adc $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 66 */   "ror $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 67 */   "rra $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 68 */   "pla",                  eImplied,     FALSE, eFlowNext},
+    {/* 69 */   "adc #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* 6a */   "ror a",                eImplied,     FALSE, eFlowNext},
+    {/* 6b */   "arr #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 6c */   "jmp ($%4.4x)",         eWord,        FALSE, eFlowIndirect},
+    {/* 6d */   "adc $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 6e */   "ror $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 6f */   "rra $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* 70 */   "bvs $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* 71 */   "adc ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* 72 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 73 */   "rra ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* 74 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 75 */   "adc $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 76 */   "ror $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 77 */   "rra $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* 78 */   "sei",                  eImplied,     FALSE, eFlowNext},
+    {/* 79 */   "adc $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* 7a */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* 7b */   "rra $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 7c */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* 7d */   "adc $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 7e */   "ror $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 7f */   "rra $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+
+    {/* 80 */   "nop #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 81 */   "sta ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* 82 */   "nop #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 83 */   "sax ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* 84 */   "sty $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 85 */   "sta $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 86 */   "stx $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* 87 */   "sax $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* 88 */   "dey",                  eImplied,     FALSE, eFlowNext},
+    {/* 89 */   "nop #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 8a */   "txa",                  eImplied,     FALSE, eFlowNext},
+    {/* 8b */   "ane #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* 8c */   "sty $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 8d */   "sta $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 8e */   "stx $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* 8f */   "sax $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* 90 */   "bcc $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* 91 */   "sta ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* 92 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* 93 */   "sha ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* 94 */   "sty $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 95 */   "sta $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* 96 */   "stx $%2.2x,y",         eByte,        FALSE, eFlowNext},
+    {/* 97 */   "sax $%2.2x,y",         eByte,        TRUE,  eFlowNext},
+    {/* 98 */   "tya",                  eImplied,     FALSE, eFlowNext},
+    {/* 99 */   "sta $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* 9a */   "txs",                  eImplied,     FALSE, eFlowNext},
+    {/* 9b */   "tas $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 9c */   "shy $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* 9d */   "sta $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* 9e */   "shx $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* 9f */   "sha $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+
+    {/* a0 */   "ldy #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* a1 */   "lda ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* a2 */   "ldx #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* a3 */   "lax ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* a4 */   "ldy $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* a5 */   "lda $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* a6 */   "ldx $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* a7 */   "lax $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* a8 */   "tay",                  eImplied,     FALSE, eFlowNext},
+    {/* a9 */   "lda #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* aa */   "tax",                  eImplied,     FALSE, eFlowNext},
+    {/* ab */   "lxa #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* ac */   "ldy $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ad */   "lda $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ae */   "ldx $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* af */   "lax $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* b0 */   "bcs $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* b1 */   "lda ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* b2 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* b3 */   "lax ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* b4 */   "ldy $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* b5 */   "lda $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* b6 */   "ldx $%2.2x,y",         eByte,        FALSE, eFlowNext},
+    {/* b7 */   "lax $%2.2x,y",         eByte,        TRUE,  eFlowNext},
+    {/* b8 */   "clv",                  eImplied,     FALSE, eFlowNext},
+    {/* b9 */   "lda $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* ba */   "tsx",                  eImplied,     FALSE, eFlowNext},
+    {/* bb */   "las $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* bc */   "ldy $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* bd */   "lda $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* be */   "ldx $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* bf */   "lax $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+
+    {/* c0 */   "cpy #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* c1 */   "cmp ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* c2 */   "nop #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* c3 */   "dcp ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* c4 */   "cpy $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* c5 */   "cmp $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* c6 */   "dec $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* c7 */   "dcp $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* c8 */   "iny",                  eImplied,     FALSE, eFlowNext},
+    {/* c9 */   "cmp #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* ca */   "dex",                  eImplied,     FALSE, eFlowNext},
+    {/* cb */   "sbx #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* cc */   "cpy $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* cd */   "cmp $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ce */   "dec $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* cf */   "dcp $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* d0 */   "bne $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* d1 */   "cmp ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* d2 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* d3 */   "dcp ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* d4 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* d5 */   "cmp $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* d6 */   "dec $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* d7 */   "dcp $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* d8 */   "cld",                  eImplied,     FALSE, eFlowNext},
+    {/* d9 */   "cmp $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* da */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* db */   "dcp $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* dc */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* dd */   "cmp $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* de */   "dec $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* df */   "dcp $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+
+    {/* e0 */   "cpx #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* e1 */   "sbc ($%2.2x,x)",       eByte,        FALSE, eFlowNext},
+    {/* e2 */   "nop #$%2.2x",          eByte,        TRUE,  eFlowNext},
+    {/* e3 */   "isc ($%2.2x,x)",       eByte,        TRUE,  eFlowNext},
+    {/* e4 */   "cpx $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* e5 */   "sbc $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* e6 */   "inc $%2.2x",           eByte,        FALSE, eFlowNext},
+    {/* e7 */   "isc $%2.2x",           eByte,        TRUE,  eFlowNext},
+    {/* e8 */   "inx",                  eImplied,     FALSE, eFlowNext},
+    {/* e9 */   "sbc #$%2.2x",          eByte,        FALSE, eFlowNext},
+    {/* ea */   "nop",                  eImplied,     FALSE, eFlowNext},
+    {/* eb */   "usbc #$%2.2x",         eByte,        TRUE,  eFlowNext},
+    {/* ec */   "cpx $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ed */   "sbc $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ee */   "inc $%4.4x",           eWord,        FALSE, eFlowNext},
+    {/* ef */   "isc $%4.4x",           eWord,        TRUE,  eFlowNext},
+
+    {/* f0 */   "beq $%4.4x",           eRelative,    FALSE, eFlowBranch},
+    {/* f1 */   "sbc ($%2.2x),y",       eByte,        FALSE, eFlowNext},
+    {/* f2 */   "jam",                  eImplied,     TRUE,  eFlowHalt},
+    {/* f3 */   "isc ($%2.2x),y",       eByte,        TRUE,  eFlowNext},
+    {/* f4 */   "nop $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* f5 */   "sbc $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* f6 */   "inc $%2.2x,x",         eByte,        FALSE, eFlowNext},
+    {/* f7 */   "isc $%2.2x,x",         eByte,        TRUE,  eFlowNext},
+    {/* f8 */   "sed",                  eImplied,     FALSE, eFlowNext},
+    {/* f9 */   "sbc $%4.4x,y",         eWord,        FALSE, eFlowNext},
+    {/* fa */   "nop",                  eImplied,     TRUE,  eFlowNext},
+    {/* fb */   "isc $%4.4x,y",         eWord,        TRUE,  eFlowNext},
+    {/* fc */   "nop $%4.4x,x",         eWord,        TRUE,  eFlowNext},
+    {/* fd */   "sbc $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* fe */   "inc $%4.4x,x",         eWord,        FALSE, eFlowNext},
+    {/* ff */   "isc $%4.4x,x",         eWord,        TRUE,  eFlowNext},
 };
 
-word C6502_Disassemble(FILE *input, word address)
+/* Cycles for each opcode on an NMOS 6502.  P marks the indexed reads that
+   take a cycle longer when the index crosses a page.  Branches take one
+   cycle longer when taken, and another if that crosses a page.  Jams never
+   complete, so are given no cycles.
+*/
+#define P       0x80
+
+static const byte cycletable[256] =
+{
+    /* 00 */   7,   6,   0,   8,   3,   3,   5,   5,
+    /* 08 */   3,   2,   2,   2,   4,   4,   6,   6,
+    /* 10 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* 18 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7,
+    /* 20 */   6,   6,   0,   8,   3,   3,   5,   5,
+    /* 28 */   4,   2,   2,   2,   4,   4,   6,   6,
+    /* 30 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* 38 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7,
+    /* 40 */   6,   6,   0,   8,   3,   3,   5,   5,
+    /* 48 */   3,   2,   2,   2,   3,   4,   6,   6,
+    /* 50 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* 58 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7,
+    /* 60 */   6,   6,   0,   8,   3,   3,   5,   5,
+    /* 68 */   4,   2,   2,   2,   5,   4,   6,   6,
+    /* 70 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* 78 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7,
+    /* 80 */   2,   6,   2,   6,   3,   3,   3,   3,
+    /* 88 */   2,   2,   2,   2,   4,   4,   4,   4,
+    /* 90 */   2,   6,   0,   6,   4,   4,   4,   4,
+    /* 98 */   2,   5,   2,   5,   5,   5,   5,   5,
+    /* a0 */   2,   6,   2,   6,   3,   3,   3,   3,
+    /* a8 */   2,   2,   2,   2,   4,   4,   4,   4,
+    /* b0 */   2, 5|P,   0, 5|P,   4,   4,   4,   4,
+    /* b8 */   2, 4|P,   2, 4|P, 4|P, 4|P, 4|P, 4|P,
+    /* c0 */   2,   6,   2,   8,   3,   3,   5,   5,
+    /* c8 */   2,   2,   2,   2,   4,   4,   6,   6,
+    /* d0 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* d8 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7,
+    /* e0 */   2,   6,   2,   8,   3,   3,   5,   5,
+    /* e8 */   2,   2,   2,   2,   4,   4,   6,   6,
+    /* f0 */   2, 5|P,   0,   8,   4,   4,   6,   6,
+    /* f8 */   2, 4|P,   2,   7, 4|P, 4|P,   7,   7
+};
+
+#undef P
+
+/* Most common opcodes in typical code, most frequent first
+*/
+const word C6502_Model[] =
+{
+    0xa9, 0x85, 0x20, 0xa5, 0x8d, 0xd0, 0x60, 0xad,
+    0xf0, 0x4c, 0xc9, 0xa2, 0xa0, 0x91, 0xb1, 0xbd,
+    0x9d, 0x18, 0x69, 0xc8, 0xe8, 0x10, 0x90, 0xb0,
+    0x29, 0xca, 0x88, 0x48, 0x68, 0x86, 0x84, 0xa6,
+    0xa4, 0xaa, 0xa8, 0x8a, 0x98, 0x38, 0xe9, 0xe6,
+    0xc6, 0x09, 0x0a, 0x4a, 0x30, 0xb9, 0x99, 0x65,
+    0xee, 0xce, 0x2c, 0x24, 0xe0, 0xc0, 0xc5, 0xcd,
+    0x8e, 0x8c, 0xae, 0xac, 0x6c, 0x40, 0x78, 0xd8,
+    0x58, 0xb5, 0x95, 0x49, 0x2a, 0x6a, 0x26, 0x66,
+    0x06, 0x46, 0xdd, 0xd9, 0xfd, 0xf9, 0x7d, 0x79,
+    0x50, 0x70, 0xea, 0x08, 0x28, 0x9a, 0xba, 0xe4,
+    MODEL_END
+};
+
+int C6502_Decode(const byte *data, ulong size, word address,
+                 decode_t *decode)
+{
+    const opcode_t *op;
+    int length;
+
+    if (size < 1)
+    {
+        return 0;
+    }
+
+    op = optable + data[0];
+
+    switch(op->argtype)
+    {
+        case eByte:
+        case eRelative:
+            length = 2;
+            break;
+
+        case eWord:
+            length = 3;
+            break;
+
+        default:
+            length = 1;
+            break;
+    }
+
+    if (size < (ulong)length)
+    {
+        return 0;
+    }
+
+    decode->address = address;
+    decode->length = length;
+    decode->page = 0;
+    decode->opcode = data[0];
+    decode->illegal = op->illegal;
+    decode->flow = op->flow;
+    decode->conditional = FALSE;
+    decode->has_target = FALSE;
+    decode->target = 0;
+    decode->cycles = cycletable[data[0]] & 0x7f;
+    decode->cycles_max = decode->cycles + (cycletable[data[0]] >> 7);
+
+    if (op->argtype == eRelative)
+    {
+        decode->has_target = TRUE;
+        decode->target = (address + 2 + (relative)data[1]) & 0xffff;
+        decode->cycles_max = decode->cycles + 1 +
+                    ((decode->target & 0xff00) != ((address + 2) & 0xff00));
+    }
+    else if (data[0] == 0x20 || data[0] == 0x4c)
+    {
+        decode->has_target = TRUE;
+        decode->target = data[1] | data[2] << 8;
+    }
+
+    decode->has_operand = op->argtype != eImplied;
+
+    switch(op->argtype)
+    {
+        case eByte:
+            decode->operand = data[1];
+            break;
+
+        case eWord:
+            decode->operand = data[1] | data[2] << 8;
+            break;
+
+        case eRelative:
+            decode->operand = decode->target;
+            break;
+
+        default:
+            decode->operand = 0;
+            break;
+    }
+
+    return length;
+}
+
+int C6502_Entries(const byte *data, ulong size, word origin,
+                  word *entry, int max)
+{
+    int no = 0;
+    word vec;
+
+    if (no < max)
+    {
+        entry[no++] = origin;
+    }
+
+    /* The NMI, RESET and IRQ vectors if the image covers them
+    */
+    for(vec = 0xfffa; vec < 0x10000 && no < max; vec += 2)
+    {
+        if (vec >= origin && vec + 1 < origin + size)
+        {
+            entry[no++] = data[vec - origin] | data[vec - origin + 1] << 8;
+        }
+    }
+
+    return no;
+}
+
+word C6502_Disassemble(input_t *input, word address)
 {
     memory_t mem = INIT_MEMORY;
     word start_address;
@@ -333,7 +506,7 @@ word C6502_Disassemble(FILE *input, word address)
 
     opcode = GetByte(input, &address, &mem);
 
-    if (feof(input))
+    if (InputEOF(input))
     {
         return start_address;
     }
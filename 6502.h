@@ -26,10 +26,17 @@
 #ifndef DASM_6502_H
 #define DASM_6502_H
 
-#include <stdio.h>
 #include "global.h"
+#include "input.h"
+#include "decode.h"
 
-word C6502_Disassemble(FILE *input, word address);
+word C6502_Disassemble(input_t *input, word address);
+int C6502_Decode(const byte *data, ulong size, word address,
+                 decode_t *decode);
+int C6502_Entries(const byte *data, ulong size, word origin,
+                  word *entry, int max);
+
+extern const word C6502_Model[];
 
 #endif
 
@@ -0,0 +1,501 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Compressed inputs.
+
+    A gzip file is a series of members, each a header, a deflate stream and
+    a trailer giving the CRC and length of the data.  Since the length of
+    the compressed data is not stored the next member is only found once
+    the stream before it has been read to the end.
+
+    A zip archive is read from its central directory at the end of the file,
+    which gives the name, method, sizes and local header of every member.
+    Only stored and deflated members are read.  Neither format is ever
+    decompressed whole, only as much as the caller asks for at a time.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "archive.h"
+#include "util.h"
+
+#define GZIP_HEADER     10
+#define GZIP_TRAILER    8
+
+#define FHCRC           0x02
+#define FEXTRA          0x04
+#define FNAME           0x08
+#define FCOMMENT        0x10
+
+#define ZIP_LOCAL       0x04034b50ul
+#define ZIP_CENTRAL     0x02014b50ul
+#define ZIP_END         0x06054b50ul
+
+#define LOCAL_SIZE      30
+#define CENTRAL_SIZE    46
+#define END_SIZE        22
+#define MAX_COMMENT     0xffff
+
+#define METHOD_STORED   0
+#define METHOD_DEFLATE  8
+
+#define ZIP64           0xfffffffful
+
+#define DRAIN_SIZE      0x1000
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static ulong crc_table[256];
+static int crc_init;
+
+
+/* ---------------------------------------- UTILS
+*/
+static ulong CRC(ulong crc, const byte *p, ulong size)
+{
+    if (!crc_init)
+    {
+        ulong n;
+        int f;
+
+        for(n = 0; n < 256; n++)
+        {
+            ulong c = n;
+
+            for(f = 0; f < 8; f++)
+            {
+                c = c & 1 ? 0xedb88320ul ^ (c >> 1) : c >> 1;
+            }
+
+            crc_table[n] = c;
+        }
+
+        crc_init = TRUE;
+    }
+
+    crc ^= 0xfffffffful;
+
+    while(size--)
+    {
+        crc = crc_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xfffffffful;
+}
+
+static void Warn(const archive_t *a, const char *message)
+{
+    fprintf(stderr, "dasm: %s member %s: %s\n", a->format, a->name, message);
+}
+
+static void SetName(archive_t *a, const byte *name, ulong len)
+{
+    if (len == 0)
+    {
+        sprintf(a->name, "#%d", a->no + 1);
+        return;
+    }
+
+    if (len >= ARCHIVE_NAME)
+    {
+        len = ARCHIVE_NAME - 1;
+    }
+
+    memcpy(a->name, name, len);
+    a->name[len] = 0;
+}
+
+static void Start(archive_t *a, const byte *member, ulong size, int method)
+{
+    a->method = method;
+    a->member = member;
+    a->member_size = size;
+    a->pos = 0;
+    a->crc = 0;
+    a->length = 0;
+    a->open = TRUE;
+    a->no++;
+
+    if (method == METHOD_DEFLATE)
+    {
+        InflateInit(&a->z, member, size);
+    }
+}
+
+/* Reads the header of the gzip member at next.  Anything after the last
+   member that isn't another one is ignored, as gzip does.
+*/
+static int NextGzip(archive_t *a)
+{
+    const byte *p = a->data + a->next;
+    ulong left = a->size - a->next;
+    ulong pos = GZIP_HEADER;
+    int flags;
+
+    if (left < GZIP_HEADER + GZIP_TRAILER || p[0] != 0x1f || p[1] != 0x8b)
+    {
+        return FALSE;
+    }
+
+    SetName(a, NULL, 0);
+
+    if (p[2] != METHOD_DEFLATE)
+    {
+        Warn(a, "unknown compression method");
+        return FALSE;
+    }
+
+    flags = p[3];
+
+    if (flags & FEXTRA)
+    {
+        pos += 2 + Get16(p + pos);
+    }
+
+    if (flags & FNAME)
+    {
+        ulong start = pos;
+
+        while(pos < left && p[pos])
+        {
+            pos++;
+        }
+
+        SetName(a, p + start, pos - start);
+        pos++;
+    }
+
+    if (flags & FCOMMENT)
+    {
+        while(pos < left && p[pos])
+        {
+            pos++;
+        }
+
+        pos++;
+    }
+
+    if (flags & FHCRC)
+    {
+        pos += 2;
+    }
+
+    if (pos >= left)
+    {
+        Warn(a, "truncated header");
+        return FALSE;
+    }
+
+    Start(a, p + pos, left - pos, METHOD_DEFLATE);
+
+    return TRUE;
+}
+
+/* Looks at the next entry of the central directory, returning FALSE if
+   it cannot be read.  skip is set for entries with nothing to read.
+*/
+static int NextZipEntry(archive_t *a, int *skip)
+{
+    const byte *p = a->data + a->next;
+    ulong flags;
+    ulong method;
+    ulong size;
+    ulong local;
+    ulong name_len;
+    ulong start;
+
+    *skip = TRUE;
+
+    if (a->next + CENTRAL_SIZE > a->size || Get32(p) != ZIP_CENTRAL)
+    {
+        fprintf(stderr, "dasm: zip: bad central directory\n");
+        return FALSE;
+    }
+
+    flags = Get16(p + 8);
+    method = Get16(p + 10);
+    size = Get32(p + 20);
+    name_len = Get16(p + 28);
+    local = Get32(p + 42);
+
+    a->next += CENTRAL_SIZE + name_len + Get16(p + 30) + Get16(p + 32);
+
+    if (a->next > a->size)
+    {
+        fprintf(stderr, "dasm: zip: bad central directory\n");
+        return FALSE;
+    }
+
+    SetName(a, p + CENTRAL_SIZE, name_len);
+
+    if (name_len && p[CENTRAL_SIZE + name_len - 1] == '/')
+    {
+        return TRUE;
+    }
+
+    if (flags & 1)
+    {
+        Warn(a, "encrypted, skipped");
+        return TRUE;
+    }
+
+    if (method != METHOD_STORED && method != METHOD_DEFLATE)
+    {
+        Warn(a, "unsupported compression method, skipped");
+        return TRUE;
+    }
+
+    if (size == ZIP64 || Get32(p + 24) == ZIP64 || local == ZIP64)
+    {
+        Warn(a, "ZIP64 members are not supported, skipped");
+        return TRUE;
+    }
+
+    if (local + LOCAL_SIZE > a->size ||
+        Get32(a->data + local) != ZIP_LOCAL)
+    {
+        Warn(a, "bad local header, skipped");
+        return TRUE;
+    }
+
+    start = local + LOCAL_SIZE + Get16(a->data + local + 26) +
+                                 Get16(a->data + local + 28);
+
+    if (start > a->size || size > a->size - start)
+    {
+        Warn(a, "truncated, skipped");
+        return TRUE;
+    }
+
+    Start(a, a->data + start, size, (int)method);
+    a->expect_crc = Get32(p + 16);
+    a->expect_length = Get32(p + 24);
+    *skip = FALSE;
+
+    return TRUE;
+}
+
+/* Finds the end of central directory record, which is followed by a comment
+   of up to 64K.
+*/
+static int FindZipEnd(archive_t *a)
+{
+    ulong pos;
+    ulong stop;
+
+    if (a->size < END_SIZE)
+    {
+        return FALSE;
+    }
+
+    pos = a->size - END_SIZE;
+    stop = pos > MAX_COMMENT ? pos - MAX_COMMENT : 0;
+
+    for(;;)
+    {
+        if (Get32(a->data + pos) == ZIP_END)
+        {
+            a->entries = Get16(a->data + pos + 10);
+            a->first = Get32(a->data + pos + 16);
+
+            return a->first <= pos;
+        }
+
+        if (pos == stop)
+        {
+            return FALSE;
+        }
+
+        pos--;
+    }
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int ArchiveOpen(archive_t *a, const byte *data, ulong size)
+{
+    memset(a, 0, sizeof *a);
+
+    a->data = data;
+    a->size = size;
+
+    if (size >= GZIP_HEADER + GZIP_TRAILER &&
+        data[0] == 0x1f && data[1] == 0x8b && data[2] == METHOD_DEFLATE)
+    {
+        a->type = eArchiveGzip;
+        a->format = "gzip";
+        ArchiveRewind(a);
+
+        return TRUE;
+    }
+
+    if (size >= LOCAL_SIZE && Get32(data) == ZIP_LOCAL)
+    {
+        a->type = eArchiveZip;
+        a->format = "zip";
+
+        if (FindZipEnd(a))
+        {
+            ArchiveRewind(a);
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+void ArchiveRewind(archive_t *a)
+{
+    a->open = FALSE;
+    a->no = 0;
+
+    if (a->type == eArchiveZip)
+    {
+        FindZipEnd(a);
+        a->next = a->first;
+    }
+    else
+    {
+        a->next = 0;
+    }
+}
+
+int ArchiveNext(archive_t *a)
+{
+    if (a->type == eArchiveGzip)
+    {
+        if (a->open)
+        {
+            byte drain[DRAIN_SIZE];
+
+            while(ArchiveRead(a, drain, sizeof drain) > 0)
+            {
+            }
+        }
+
+        return NextGzip(a);
+    }
+
+    a->open = FALSE;
+
+    while(a->entries)
+    {
+        int skip;
+
+        a->entries--;
+
+        if (!NextZipEntry(a, &skip))
+        {
+            a->entries = 0;
+            return FALSE;
+        }
+
+        if (!skip)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+long ArchiveRead(archive_t *a, byte *buff, ulong size)
+{
+    ulong n;
+
+    if (!a->open)
+    {
+        return 0;
+    }
+
+    if (a->method == METHOD_STORED)
+    {
+        n = a->member_size - a->pos;
+        n = n < size ? n : size;
+        memcpy(buff, a->member + a->pos, n);
+        a->pos += n;
+    }
+    else
+    {
+        n = InflateRead(&a->z, buff, size);
+
+        /* Whatever came out before the damage is passed on first
+        */
+        if (a->z.error && n == 0)
+        {
+            Warn(a, a->z.error);
+            a->open = FALSE;
+            a->entries = 0;
+            a->next = a->size;
+            return -1;
+        }
+    }
+
+    if (n)
+    {
+        a->crc = CRC(a->crc, buff, n);
+        a->length += n;
+
+        return (long)n;
+    }
+
+    a->open = FALSE;
+
+    if (a->type == eArchiveGzip)
+    {
+        const byte *trailer = a->member + a->z.in_pos;
+
+        if (a->z.in_pos + GZIP_TRAILER > a->member_size)
+        {
+            Warn(a, "truncated trailer");
+            a->next = a->size;
+            return -1;
+        }
+
+        a->expect_crc = Get32(trailer);
+        a->expect_length = Get32(trailer + 4);
+        a->next = (ulong)(trailer - a->data) + GZIP_TRAILER;
+    }
+
+    if (a->crc != a->expect_crc)
+    {
+        Warn(a, "CRC does not match");
+        return -1;
+    }
+
+    if ((a->length & 0xfffffffful) != a->expect_length)
+    {
+        Warn(a, "length does not match");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
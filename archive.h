@@ -0,0 +1,94 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Compressed inputs.
+
+*/
+
+#ifndef DASM_ARCHIVE_H
+#define DASM_ARCHIVE_H
+
+#include "global.h"
+#include "inflate.h"
+
+#define ARCHIVE_NAME    256
+
+typedef enum
+{
+    eArchiveGzip,
+    eArchiveZip
+} archive_type_t;
+
+/* A gzip file or zip archive held in memory, read a member at a time
+*/
+typedef struct
+{
+    archive_type_t      type;
+    const char          *format;        /* "gzip" or "zip" */
+    int                 no;             /* Members opened so far */
+    char                name[ARCHIVE_NAME];
+
+    /* Private
+    */
+    const byte          *data;
+    ulong               size;
+    ulong               next;           /* Where the next member is found */
+    ulong               entries;        /* Zip entries not yet looked at */
+    ulong               first;          /* Zip central directory */
+
+    int                 method;
+    const byte          *member;        /* The compressed member */
+    ulong               member_size;
+    ulong               pos;            /* Read position of a stored member */
+    ulong               crc;
+    ulong               length;
+    ulong               expect_crc;
+    ulong               expect_length;
+    int                 open;
+
+    inflate_t           z;
+} archive_t;
+
+/* Returns TRUE if data is a gzip file or zip archive, ready for the first
+   call to ArchiveNext.
+*/
+int ArchiveOpen(archive_t *a, const byte *data, ulong size);
+
+/* Moves on to the next member, returning FALSE when there are no more.
+   Members that cannot be decompressed are skipped with a warning.
+*/
+int ArchiveNext(archive_t *a);
+
+/* Goes back to before the first member
+*/
+void ArchiveRewind(archive_t *a);
+
+/* Reads up to size bytes of the current member, returning 0 at its end
+   or -1 after reporting an error.  The member's CRC and length are checked
+   once it has all been read.
+*/
+long ArchiveRead(archive_t *a, byte *buff, ulong size);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
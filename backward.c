@@ -0,0 +1,212 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Backward disassembly.
+
+    Every offset a short way back from the address is decoded once.  Walking
+    down from the address, an offset is on a path to it if the instruction
+    there ends exactly on the address or on another offset that is, which
+    also gives the number of instructions from each offset to the address.
+    The offsets exactly the wanted number of instructions back are then
+    scored on how well their instructions fit the CPU's opcode model, on
+    illegal opcodes, and on how many of the offsets just before them fall
+    into step with them, since the decoders of variable length code tend to
+    resynchronise on the real instruction boundaries.  The window is sized
+    by the CPU's longest instruction, and offsets its instructions cannot
+    be aligned to are never decoded.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "backward.h"
+#include "detect.h"
+
+/* Bytes looked back beyond the longest possible run of instructions, so
+   that paths have room to converge
+*/
+#define SLACK           16
+
+#define WINDOW          (BACKWARD_MAX * MAX_INSTRUCTION + SLACK)
+
+/* Offsets before a candidate tried to see if they fall into step with it
+*/
+#define SUPPORT_SPAN    16
+
+/* Weights of the measures
+*/
+#define W_ILLEGAL       6.0
+#define W_SUPPORT       2.0
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static ulong next_pos[WINDOW];
+static int depth[WINDOW + 1];
+static double sum[WINDOW + 1];
+
+static double llr[MODEL_KEYS];
+static const word *llr_model;
+
+
+/* ---------------------------------------- UTILS
+*/
+
+/* Returns the share of the aligned offsets just before p whose instructions
+   step onto p, as a log2.
+*/
+static double Support(ulong p, int align)
+{
+    ulong q = p > SUPPORT_SPAN ? p - SUPPORT_SPAN : 0;
+    int hits = 0;
+    int tried = 0;
+
+    for(q -= q % (ulong)align; q < p; q += (ulong)align)
+    {
+        ulong at = q;
+
+        while(at < p)
+        {
+            at = next_pos[at];
+        }
+
+        hits += at == p;
+        tried++;
+    }
+
+    return log((hits + 1.0) / (tried + 1.0)) / log(2.0);
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int Backward(const CPU *cpu, const byte *data, ulong size, word origin,
+             word address, int count, word *start)
+{
+    double best_score = 0;
+    long best = -1;
+    int want = 0;
+    ulong off;
+    ulong lo;
+    ulong n;
+    ulong p;
+    int f;
+
+    if (address < origin || address - origin > size || count <= 0)
+    {
+        return 0;
+    }
+
+    if (count > BACKWARD_MAX)
+    {
+        count = BACKWARD_MAX;
+    }
+
+    if (cpu->model != llr_model)
+    {
+        DetectModel(cpu->model, llr);
+        llr_model = cpu->model;
+    }
+
+    /* The window is a whole number of alignments long, so that the offsets
+       in step with the address are those that divide by it
+    */
+    off = address - origin;
+    n = (ulong)count * (ulong)cpu->max_length + SLACK;
+    lo = off > n ? off - n : 0;
+    n = off - lo;
+    n -= n % (ulong)cpu->align;
+    lo = off - n;
+
+    depth[n] = 0;
+    sum[n] = 0;
+
+    for(p = n; p-- > 0;)
+    {
+        decode_t d;
+        int len;
+        int key;
+
+        if (p % (ulong)cpu->align)
+        {
+            next_pos[p] = n + 1;
+            depth[p] = -1;
+            continue;
+        }
+
+        len = cpu->decode(data + lo + p, size - lo - p, origin + lo + p, &d);
+        next_pos[p] = len ? p + (ulong)len : n + 1;
+        depth[p] = -1;
+
+        if (next_pos[p] > n || depth[next_pos[p]] < 0)
+        {
+            continue;
+        }
+
+        key = d.page << 8 | d.opcode;
+        depth[p] = depth[next_pos[p]] + 1;
+        sum[p] = sum[next_pos[p]] + (key < MODEL_KEYS ? llr[key] : llr[0]) -
+                        (d.illegal ? W_ILLEGAL : 0);
+
+        if (depth[p] <= count && depth[p] > want)
+        {
+            want = depth[p];
+        }
+    }
+
+    for(p = 0; p < n; p++)
+    {
+        double score;
+
+        if (depth[p] != want)
+        {
+            continue;
+        }
+
+        score = sum[p] / want + W_SUPPORT * Support(p, cpu->align);
+
+        if (best == -1 || score > best_score)
+        {
+            best = (long)p;
+            best_score = score;
+        }
+    }
+
+    if (best == -1)
+    {
+        return 0;
+    }
+
+    for(p = (ulong)best, f = 0; f < want; f++)
+    {
+        start[f] = origin + (word)(lo + p);
+        p = next_pos[p];
+    }
+
+    return want;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
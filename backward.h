@@ -0,0 +1,49 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Backward disassembly.
+
+*/
+
+#ifndef DASM_BACKWARD_H
+#define DASM_BACKWARD_H
+
+#include "global.h"
+#include "decode.h"
+
+/* Most instructions that can be asked for at once
+*/
+#define BACKWARD_MAX    256
+
+/* Finds the most plausible run of count instructions that ends exactly at
+   address, in data which is loaded at origin.  The addresses of the
+   instructions are put in start, oldest first, and the number found is
+   returned.  This is less than count only if the start of data is reached,
+   and zero if no run of instructions leads to address.
+*/
+int Backward(const CPU *cpu, const byte *data, ulong size, word origin,
+             word address, int count, word *start);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
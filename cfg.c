@@ -0,0 +1,361 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Basic blocks and control flow graphs.
+
+    Each segment is swept twice with the CPU's decoder.  The first pass
+    marks where instructions start and where blocks must start: after any
+    instruction that changes the flow of control, and at the target of any
+    branch, jump or call.  The second pass cuts the blocks at the marks that
+    fall on an instruction and adds the edges of each block as it closes.
+    Since blocks are made in address order their edges are appended in
+    order too, which gives the compressed rows directly.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cfg.h"
+#include "util.h"
+
+#define START           0x01    /* An instruction starts here */
+#define LEADER          0x02    /* A block must start here */
+
+
+/* ---------------------------------------- UTILS
+*/
+static void AddBlock(cfg_t *cfg, ulong *alloc, word start, int bank)
+{
+    block_t *b;
+
+    if (cfg->no + 1 >= *alloc)
+    {
+        *alloc = *alloc ? *alloc * 2 : 1024;
+        cfg->block = Alloc(cfg->block, sizeof *cfg->block * *alloc);
+        cfg->first = Alloc(cfg->first, sizeof *cfg->first * (*alloc + 1));
+    }
+
+    b = cfg->block + cfg->no;
+    b->start = start;
+    b->end = start;
+    b->bank = bank;
+    b->flow = eFlowNext;
+
+    cfg->no++;
+}
+
+static void AddEdge(cfg_t *cfg, ulong *alloc, ulong to, edge_kind_t kind)
+{
+    if (cfg->no_edges == *alloc)
+    {
+        *alloc = *alloc ? *alloc * 2 : 2048;
+        cfg->edge = Alloc(cfg->edge, sizeof *cfg->edge * *alloc);
+        cfg->kind = Alloc(cfg->kind, *alloc);
+    }
+
+    cfg->edge[cfg->no_edges] = to;
+    cfg->kind[cfg->no_edges++] = (byte)kind;
+}
+
+/* Finds the block starting at address among blocks first to last, returning
+   -1 if there is none.
+*/
+static long FindBlock(const cfg_t *cfg, ulong first, ulong last,
+                      word address)
+{
+    long lo = (long)first;
+    long hi = (long)last;
+
+    while(lo <= hi)
+    {
+        long mid = lo + (hi - lo) / 2;
+
+        if (cfg->block[mid].start == address)
+        {
+            return mid;
+        }
+        else if (cfg->block[mid].start < address)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+static void MarkSegment(const CPU *cpu, const segment_t *seg, byte *mark)
+{
+    ulong pos = 0;
+
+    mark[0] |= LEADER;
+
+    while(pos < seg->size)
+    {
+        word address = seg->address + (word)pos;
+        decode_t d;
+        int len;
+
+        if (!(len = cpu->decode(seg->data + pos, seg->size - pos,
+                                address, &d)))
+        {
+            break;
+        }
+
+        mark[pos] |= START;
+        pos += (ulong)len;
+
+        if (d.flow != eFlowNext && pos < seg->size)
+        {
+            mark[pos] |= LEADER;
+        }
+
+        if (d.has_target && d.target >= seg->address &&
+            d.target - seg->address < seg->size)
+        {
+            mark[d.target - seg->address] |= LEADER;
+        }
+    }
+}
+
+/* Adds the edges of the blocks from first onwards, all in one segment.
+   tail holds the last instruction of each block.
+*/
+static void JoinSegment(cfg_t *cfg, ulong *alloc, ulong first,
+                        const decode_t *tail)
+{
+    ulong last = cfg->no - 1;
+    ulong n;
+
+    for(n = first; n <= last; n++)
+    {
+        const decode_t *d = tail + (n - first);
+        long to;
+
+        cfg->first[n] = cfg->no_edges;
+
+        switch(d->flow)
+        {
+            case eFlowNext:
+            case eFlowBranch:
+            case eFlowCall:
+                if (d->flow != eFlowNext && d->has_target &&
+                    (to = FindBlock(cfg, first, last, d->target)) != -1)
+                {
+                    AddEdge(cfg, alloc, (ulong)to,
+                            d->flow == eFlowCall ? eEdgeCall : eEdgeBranch);
+                }
+
+                if (n < last &&
+                    cfg->block[n + 1].start == cfg->block[n].end + 1)
+                {
+                    AddEdge(cfg, alloc, n + 1, eEdgeNext);
+                }
+                break;
+
+            case eFlowJump:
+                if (d->has_target &&
+                    (to = FindBlock(cfg, first, last, d->target)) != -1)
+                {
+                    AddEdge(cfg, alloc, (ulong)to, eEdgeJump);
+                }
+                break;
+
+            case eFlowReturn:
+                if (d->conditional && n < last)
+                {
+                    AddEdge(cfg, alloc, n + 1, eEdgeNext);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void CFGBuild(cfg_t *cfg, const CPU *cpu, const image_t *img)
+{
+    ulong block_alloc = 0;
+    ulong edge_alloc = 0;
+    ulong tail_alloc = 0;
+    decode_t *tail = NULL;
+    int n;
+
+    memset(cfg, 0, sizeof *cfg);
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+        ulong first = cfg->no;
+        ulong pos = 0;
+        byte *mark;
+
+        if (seg->size == 0)
+        {
+            continue;
+        }
+
+        mark = Alloc(NULL, seg->size);
+        memset(mark, 0, seg->size);
+        MarkSegment(cpu, seg, mark);
+
+        while(pos < seg->size && (mark[pos] & START))
+        {
+            word address = seg->address + (word)pos;
+            decode_t d;
+            int len;
+
+            len = cpu->decode(seg->data + pos, seg->size - pos, address, &d);
+
+            if (mark[pos] & LEADER || cfg->no == first)
+            {
+                AddBlock(cfg, &block_alloc, address, seg->bank);
+
+                if (cfg->no - first > tail_alloc)
+                {
+                    tail_alloc = tail_alloc ? tail_alloc * 2 : 1024;
+                    tail = Alloc(tail, sizeof *tail * tail_alloc);
+                }
+            }
+
+            cfg->block[cfg->no - 1].end = address + (word)len - 1;
+            cfg->block[cfg->no - 1].flow = d.flow;
+            tail[cfg->no - 1 - first] = d;
+
+            pos += (ulong)len;
+        }
+
+        free(mark);
+
+        if (cfg->no > first)
+        {
+            JoinSegment(cfg, &edge_alloc, first, tail);
+        }
+    }
+
+    if (!cfg->first)
+    {
+        cfg->first = Alloc(NULL, sizeof *cfg->first);
+    }
+
+    cfg->first[cfg->no] = cfg->no_edges;
+
+    free(tail);
+}
+
+void CFGFree(cfg_t *cfg)
+{
+    free(cfg->block);
+    free(cfg->first);
+    free(cfg->edge);
+    free(cfg->kind);
+    memset(cfg, 0, sizeof *cfg);
+}
+
+void CFGWriteDot(const cfg_t *cfg, FILE *fp)
+{
+    static const char *style[] =
+    {
+        "",
+        " [color=green]",
+        " [color=blue]",
+        " [style=dashed]"
+    };
+
+    ulong n;
+    ulong e;
+
+    fprintf(fp, "digraph cfg {\n");
+    fprintf(fp, "    node [shape=box fontname=monospace];\n");
+
+    for(n = 0; n < cfg->no; n++)
+    {
+        const block_t *b = cfg->block + n;
+
+        if (b->bank != NO_BANK)
+        {
+            fprintf(fp, "    b%lu [label=\"%d:$%4.4x-$%4.4x\"];\n",
+                        n, b->bank, b->start, b->end);
+        }
+        else
+        {
+            fprintf(fp, "    b%lu [label=\"$%4.4x-$%4.4x\"];\n",
+                        n, b->start, b->end);
+        }
+    }
+
+    for(n = 0; n < cfg->no; n++)
+    {
+        for(e = cfg->first[n]; e < cfg->first[n + 1]; e++)
+        {
+            fprintf(fp, "    b%lu -> b%lu%s;\n",
+                        n, cfg->edge[e], style[cfg->kind[e]]);
+        }
+    }
+
+    fprintf(fp, "}\n");
+}
+
+void CFGWriteBinary(const cfg_t *cfg, FILE *fp)
+{
+    ulong n;
+
+    fwrite("DCFG", 1, 4, fp);
+    Put32(fp, CFG_VERSION);
+    Put32(fp, cfg->no);
+    Put32(fp, cfg->no_edges);
+
+    for(n = 0; n < cfg->no; n++)
+    {
+        const block_t *b = cfg->block + n;
+
+        Put32(fp, b->start);
+        Put32(fp, b->end);
+        Put16(fp, (ulong)b->bank & 0xffff);
+        putc((int)b->flow, fp);
+        putc(0, fp);
+    }
+
+    for(n = 0; n <= cfg->no; n++)
+    {
+        Put32(fp, cfg->first[n]);
+    }
+
+    for(n = 0; n < cfg->no_edges; n++)
+    {
+        Put32(fp, cfg->edge[n]);
+    }
+
+    fwrite(cfg->kind, 1, cfg->no_edges, fp);
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
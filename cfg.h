@@ -0,0 +1,93 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Basic blocks and control flow graphs.
+
+*/
+
+#ifndef DASM_CFG_H
+#define DASM_CFG_H
+
+#include <stdio.h>
+#include "global.h"
+#include "decode.h"
+#include "image.h"
+
+/* Version of the binary form.  Version 1 held 16 bit block addresses.
+*/
+#define CFG_VERSION     2
+
+typedef enum
+{
+    eEdgeNext,          /* Falls into the next block */
+    eEdgeBranch,        /* Conditional branch taken */
+    eEdgeJump,          /* Unconditional jump */
+    eEdgeCall           /* Subroutine call */
+} edge_kind_t;
+
+typedef struct
+{
+    word        start;          /* Address of the first instruction */
+    word        end;            /* Address of the last byte */
+    int         bank;           /* Bank of the segment, or NO_BANK */
+    flow_t      flow;           /* Flow of the last instruction */
+} block_t;
+
+/* The graph is held in compressed sparse row form: the edges leaving block
+   n are edge[first[n]] to edge[first[n + 1] - 1].
+*/
+typedef struct
+{
+    ulong       no;
+    block_t     *block;
+    ulong       *first;
+
+    ulong       no_edges;
+    ulong       *edge;          /* Index of the destination block */
+    byte        *kind;          /* edge_kind_t of each edge */
+} cfg_t;
+
+/* Splits the code in each segment of an image into basic blocks and joins
+   them into a graph.  Edges only join blocks in the same segment.
+*/
+void CFGBuild(cfg_t *cfg, const CPU *cpu, const image_t *img);
+
+void CFGFree(cfg_t *cfg);
+
+/* Writes a graph in Graphviz DOT form
+*/
+void CFGWriteDot(const cfg_t *cfg, FILE *fp);
+
+/* Writes a graph in a compact binary form.  All numbers are little endian:
+
+    "DCFG", u32 version (CFG_VERSION), u32 blocks, u32 edges
+    per block: u32 start, u32 end, i16 bank, u8 flow, u8 reserved
+    u32 first edge of each block, plus one for the end
+    u32 destination block of each edge
+    u8 kind of each edge
+*/
+void CFGWriteBinary(const cfg_t *cfg, FILE *fp);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
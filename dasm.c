@@ -29,16 +29,63 @@
 
 #include "global.h"
 #include "output.h"
+#include "template.h"
+#include "decode.h"
+#include "detect.h"
+#include "image.h"
+#include "loader.h"
+#include "follow.h"
+#include "trace.h"
+#include "profile.h"
+#include "cfg.h"
+#include "region.h"
+#include "archive.h"
+#include "index.h"
+#include "backward.h"
+#include "pipeline.h"
+#include "fingerprint.h"
+#include "stats.h"
+#include "search.h"
+#include "table.h"
+#include "entropy.h"
+#include "util.h"
 
 /* ---------------------------------------- PROCESSORS
 */
 #include "z80.h"
 #include "6502.h"
+#include "m68k.h"
 
 
 /* ---------------------------------------- MACROS
 */
 
+/* Bytes read from the start of the file for CPU auto-detection
+*/
+#define DETECT_SAMPLE   0x10000
+
+/* Number of ranges listed in the profile summary
+*/
+#define HOT_RANGES      10
+
+/* Bytes on each db or dw line, and characters on each line of text
+*/
+#define DATA_WIDTH      8
+#define TEXT_WIDTH      16
+
+/* Characters in the shortest run of text found with -E, unless given
+*/
+#define TEXT_RUN        8
+
+/* Bytes decompressed at a time from a gzip or zip member
+*/
+#define STREAM_CHUNK    0x10000
+
+/* Most bytes of a db, dw or text region formatted at once with -P, which
+   keeps what each records well inside PIPE_MAX_OUTPUT
+*/
+#define PIPE_DATA       0x100
+
 
 /* ---------------------------------------- VERSION INFO
 */
@@ -51,19 +98,31 @@ static const char *dasm_usage =
 "MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
 "GNU General Public License (Version 3) for more details.\n"
 "\n"
-"usage: dasm -c cpu [-o address] [-a] [-m] file\n";
+"usage: dasm -c cpu|auto [-o address] [-a] [-m] [-u] [-x $|0x|h] [-f] [-T]\n"
+"            [-d db|ca65|devpac] [-p profile] [-t] [-g dot|bin] [-r length]\n"
+"            [-M map] [-W index] [-k spacing] [-i index] [-s address]\n"
+"            [-n count] [-b count] [-P] [--shard i/n] [-F db] [-Q db] [-S]\n"
+"            [-I index] [-q term] [-l] [-E charset[,length]] [-H]\n"
+"            [-j entries] [-e] [-z] file...\n";
 
 
 /* ---------------------------------------- TYPES
 */
 
-/* Defines a CPU
+/* A walk through the lines of a segment for -P
 */
 typedef struct
 {
-    const char          *name;
-    word                (*disassemble)(FILE *input, word address);
-} CPU;
+    const segment_t     *seg;
+    const region_list_t *regions;
+    ulong               pos;
+    word                address;
+    int                 r;
+    int                 last;           /* Region of the last line */
+    ulong               stop;           /* No line starts at or after */
+    ulong               lines;
+    word                end;            /* After the last line listed */
+} walk_t;
 
 
 /* ---------------------------------------- GLOBALS
@@ -73,17 +132,103 @@ static const CPU cpu_table[]=
     {
         "Z80",
         Z80_Disassemble,
+        Z80_Decode,
+        Z80_Model,
+        Z80_Entries,
+        4,
+        FALSE,
+        4,
+        1
     },
 
     {
         "6502",
         C6502_Disassemble,
+        C6502_Decode,
+        C6502_Model,
+        C6502_Entries,
+        4,
+        FALSE,
+        3,
+        1
+    },
+
+    {
+        "68000",
+        M68K_Disassemble,
+        M68K_Decode,
+        M68K_Model,
+        M68K_Entries,
+        6,
+        TRUE,
+        10,
+        2
     },
 
     {NULL}
 };
 
 static const CPU *cpu;
+static int auto_cpu;
+static int follow;
+static int trace;
+static profile_t *profile;
+static int timing;
+static const char *graph;
+static ulong fill_run;
+static int find_text;
+static charset_t text_charset;
+static ulong text_run = TEXT_RUN;
+static int text_bit7;
+static ulong table_entries;
+static int entropy_map;
+static int skip_random;
+static region_list_t map = INIT_REGION_LIST;
+static archive_t archive;
+static int archived;
+static const char *index_out;
+static const char *index_in;
+static const char *fingerprint_out;
+static const char *fingerprint_in;
+static int opcode_stats;
+static const char *search_db;
+static const char *search_term;
+static ulong index_spacing;
+static index_t sidecar;
+static int use_index;
+
+/* The page listed with -s and -n
+*/
+static int start_set;
+static word list_start;
+static ulong list_count;
+static ulong listed;
+static int back_count;
+static int pipelined;
+
+/* The share of the image listed with --shard, as positions through all
+   its segments in turn
+*/
+static int shard_no;
+static int shard_count;
+static ulong shard_lo;
+static ulong shard_hi;
+static ulong shard_total;
+
+/* The lines of each segment that are branched to, with -l, as a bit for
+   every byte
+*/
+static int labels;
+static byte **label_bits;
+static const image_t *label_img;
+static int label_seg;
+
+/* Cycles of the straight-line block being listed with -t
+*/
+static word block_start;
+static ulong block_min;
+static ulong block_max;
+static int block_no;
 
 
 /* ---------------------------------------- UTILS
@@ -99,68 +244,1814 @@ static int StrEqual(const char *a, const char *b)
     return tolower((unsigned char)*a) == tolower((unsigned char)*b);
 }
 
+static const CPU *FindCPU(const char *name)
+{
+    int n;
+
+    for(n = 0; cpu_table[n].name; n++)
+    {
+        if (StrEqual(cpu_table[n].name, name))
+        {
+            return cpu_table + n;
+        }
+    }
 
-/* ---------------------------------------- MAIN
+    return NULL;
+}
+
+static void Detect(const byte *data, ulong size, word address)
+{
+    int confidence;
+
+    cpu = DetectCPU(cpu_table, data, size, address, &confidence);
+
+    fprintf(stderr, "dasm: detected %s with %d%% confidence\n",
+                    cpu->name, confidence);
+}
+
+/* Reads up to size bytes from the start of the first member of the archive
 */
-int main(int argc, char *argv[])
+static ulong ArchiveSample(byte *buff, ulong size)
 {
-    FILE *fp = NULL;
-    word address = 0;
-    int f;
+    ulong len = 0;
+    long n;
+
+    if (ArchiveNext(&archive))
+    {
+        while(len < size &&
+              (n = ArchiveRead(&archive, buff + len, size - len)) > 0)
+        {
+            len += (ulong)n;
+        }
+    }
+
+    ArchiveRewind(&archive);
+
+    return len;
+}
+
+/* Hashes the options that change where lines start, so that an index is
+   only used with the same ones it was written with.
+*/
+static ulong OptionsHash(void)
+{
+    ulong hash = IndexHashValue(0, fill_run);
     int n;
 
-    OutputOption(eShowAddress, 1);
-    OutputOption(eShowMemory, 1);
+    if (find_text)
+    {
+        hash = IndexHashValue(hash, text_charset + 1);
+        hash = IndexHashValue(hash, text_run);
+        hash = IndexHashValue(hash, text_bit7);
+    }
 
-    for(f = 1; f < argc && argv[f][0] == '-'; f++)
+    hash = IndexHashValue(hash, table_entries);
+    hash = IndexHashValue(hash, skip_random);
+
+    for(n = 0; n < map.no; n++)
     {
-        switch(argv[f][1])
+        hash = IndexHashValue(hash, map.region[n].start);
+        hash = IndexHashValue(hash, map.region[n].end);
+        hash = IndexHashValue(hash, map.region[n].type);
+    }
+
+    return hash;
+}
+
+/* Parses the charset[,length] of -E
+*/
+static int ParseCharset(const char *arg)
+{
+    char name[16];
+    const char *comma = strchr(arg, ',');
+    size_t len = comma ? (size_t)(comma - arg) : strlen(arg);
+
+    if (len >= sizeof name)
+    {
+        len = sizeof name - 1;
+    }
+
+    memcpy(name, arg, len);
+    name[len] = 0;
+
+    if (!RegionCharset(name, &text_charset))
+    {
+        fprintf(stderr, "dasm: unknown character set %s\n", name);
+        return FALSE;
+    }
+
+    if (comma && (text_run = strtoul(comma + 1, NULL, 0)) < 2)
+    {
+        fprintf(stderr, "dasm: text length must be at least 2\n");
+        return FALSE;
+    }
+
+    find_text = TRUE;
+
+    return TRUE;
+}
+
+static int PageFull(void)
+{
+    return list_count && listed >= list_count;
+}
+
+/* Parses the i/n of --shard
+*/
+static int ShardParse(const char *arg)
+{
+    char *p;
+
+    shard_no = (int)strtol(arg, &p, 10);
+
+    if (*p++ != '/')
+    {
+        return FALSE;
+    }
+
+    shard_count = (int)strtol(p, &p, 10);
+
+    return *p == 0 && shard_count > 0 &&
+           shard_no > 0 && shard_no <= shard_count;
+}
+
+/* Divides the image evenly between the shards
+*/
+static void ShardSplit(const image_t *img)
+{
+    int n;
+
+    shard_total = 0;
+
+    for(n = 0; n < img->no; n++)
+    {
+        shard_total += img->segment[n].size;
+    }
+
+    /* Split the quotient and remainder so that total * i can't overflow
+    */
+    shard_lo = shard_total / shard_count * (shard_no - 1) +
+               shard_total % shard_count * (shard_no - 1) / shard_count;
+    shard_hi = shard_total / shard_count * shard_no +
+               shard_total % shard_count * shard_no / shard_count;
+}
+
+/* Returns TRUE if the comments at position pos belong to this shard
+*/
+static int ShardOwns(ulong pos)
+{
+    if (!shard_count)
+    {
+        return TRUE;
+    }
+
+    return (pos >= shard_lo && pos < shard_hi) ||
+           (pos == shard_total && shard_no == shard_count);
+}
+
+
+/* ---------------------------------------- LISTING
+*/
+static void BlockComment(word start, word end, ulong min, ulong max)
+{
+    if (min == max)
+    {
+        OutputComment("block $%4.4x-$%4.4x: %u cycles", start, end,
+                      (unsigned)min);
+    }
+    else
+    {
+        OutputComment("block $%4.4x-$%4.4x: %u-%u cycles", start, end,
+                      (unsigned)min, (unsigned)max);
+    }
+}
+
+static void ResetBlock(void)
+{
+    block_min = 0;
+    block_max = 0;
+    block_no = 0;
+}
+
+/* Ends the straight-line block being timed, which runs up to next
+*/
+static void EndBlock(word next)
+{
+    if (block_no)
+    {
+        BlockComment(block_start, next - 1, block_min, block_max);
+    }
+
+    ResetBlock();
+}
+
+/* Returns the segment that a label at address would be in when branched
+   to from segment from, or -1 if there is none.  Banks only branch within
+   themselves.
+*/
+static int LabelSegment(int from, word address)
+{
+    const segment_t *seg = label_img->segment;
+    int n;
+
+    if (address - seg[from].address < seg[from].size)
+    {
+        return from;
+    }
+
+    if (seg[from].bank != NO_BANK)
+    {
+        return -1;
+    }
+
+    for(n = 0; n < label_img->no; n++)
+    {
+        if (seg[n].bank == NO_BANK &&
+            address - seg[n].address < seg[n].size)
         {
-            case 'c':
-                for(n = 0; cpu_table[n].name && !cpu; n++)
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+static int IsLabel(word address)
+{
+    int n;
+
+    if (!label_bits || (n = LabelSegment(label_seg, address)) == -1)
+    {
+        return FALSE;
+    }
+
+    address -= label_img->segment[n].address;
+
+    return (label_bits[n][address / 8] >> (address % 8)) & 1;
+}
+
+/* Disassembles one instruction.  With -t its cycles are added to the line
+   and the block, and the block ends at any instruction that changes the
+   flow of control.  With -l it is preceded by its label and its target is
+   shown as one.
+*/
+static word Step(input_t *input, word address)
+{
+    decode_t d;
+    int ends = FALSE;
+
+    if (IsLabel(address))
+    {
+        OutputLabel(address);
+    }
+
+    if (!timing && !label_bits)
+    {
+        return cpu->disassemble(input, address);
+    }
+
+    if (cpu->decode(input->data + input->pos, input->size - input->pos,
+                    address, &d))
+    {
+        if (d.has_target && IsLabel(d.target))
+        {
+            OutputTarget(d.target);
+        }
+
+        if (timing)
+        {
+            if (block_no++ == 0)
+            {
+                block_start = address;
+            }
+
+            OutputCycles(d.cycles, d.cycles_max);
+            block_min += d.cycles;
+            block_max += d.cycles_max;
+            ends = d.flow != eFlowNext;
+        }
+    }
+
+    address = cpu->disassemble(input, address);
+
+    if (ends)
+    {
+        EndBlock(address);
+    }
+
+    return address;
+}
+
+/* Lists a region from address to its end, returning the address after it
+*/
+static word ListRegion(const region_t *r, input_t *input, word address)
+{
+    const byte *data = input->data + input->pos;
+    ulong len = (ulong)(r->end - address) + 1;
+    memory_t mem = INIT_MEMORY;
+    ulong pos = 0;
+
+    EndBlock(address);
+
+    if (IsLabel(address))
+    {
+        OutputLabel(address);
+    }
+
+    switch(r->type)
+    {
+        case eRegionFill:
+            MemoryAddByte(&mem, r->value);
+            OutputFill(address, cpu->digits, &mem, len, r->value);
+            break;
+
+        case eRegionSkip:
+            OutputComment("skipped $%4.4x-$%4.4x", address, r->end);
+            break;
+
+        default:
+            while(pos < len)
+            {
+                ulong no = len - pos;
+                data_format fmt = eDataBytes;
+
+                if (r->type == eRegionText)
                 {
-                    if (StrEqual(cpu_table[n].name, argv[f+1]))
-                    {
-                        cpu = cpu_table + n;
-                    }
+                    fmt = eDataText;
+                    no = no > TEXT_WIDTH ? TEXT_WIDTH : no;
+                }
+                else if ((r->type == eRegionWord ||
+                          r->type == eRegionTable) && no > 1)
+                {
+                    fmt = cpu->msb ? eDataWordsMSB : eDataWordsLSB;
+                    no = no > DATA_WIDTH ? DATA_WIDTH : no & ~1ul;
+                }
+                else
+                {
+                    no = no > DATA_WIDTH ? DATA_WIDTH : no;
                 }
-                f++;
-                break;
 
-            case 'o':
-                address = (word)strtol(argv[++f], NULL, 0);
-                break;
+                OutputData(address + pos, cpu->digits, data + pos, (int)no,
+                           fmt);
+                pos += no;
+            }
+            break;
+    }
 
-            case 'a':
-                OutputOption(eShowAddress, 0);
-                break;
+    input->pos += len;
 
-            case 'm':
-                OutputOption(eShowMemory, 0);
-                break;
+    return (word)(address + len);
+}
 
-            default:
-                break;
+/* Builds the regions of a segment from the map and, with -z, -r, -E and
+   -j, its compressed or encrypted data and runs of fill bytes, text and
+   addresses of code.
+*/
+static void SegmentRegions(const segment_t *seg, region_list_t *regions)
+{
+    word last = seg->address + seg->size - 1;
+    int r;
+
+    for(r = RegionNext(&map, seg->address); r < map.no; r++)
+    {
+        const region_t *m = map.region + r;
+
+        if (m->start > last)
+        {
+            break;
+        }
+
+        if (m->type != eRegionCode)
+        {
+            RegionAdd(regions,
+                      m->start < seg->address ? seg->address : m->start,
+                      m->end > last ? last : m->end, m->type, 0);
+        }
+    }
+
+    if (skip_random)
+    {
+        entropy_t *e;
+        ulong no = EntropyMap(cpu, seg->data, seg->size, seg->address, &e);
+        ulong f;
+
+        for(f = 0; f < no; f++)
+        {
+            if (e[f].type == eRegionSkip)
+            {
+                word start = (word)(seg->address + e[f].pos);
+
+                RegionAddGaps(regions, start,
+                              (word)(start + e[f].size - 1), eRegionSkip, 0);
+            }
         }
+
+        free(e);
     }
 
-    if (f < argc)
+    if (fill_run)
     {
-        fp = fopen(argv[f], "rb");
+        region_list_t fill = INIT_REGION_LIST;
+
+        RegionFindFills(&fill, seg->data, seg->size, seg->address,
+                        fill_run, regions);
+
+        for(r = 0; r < fill.no; r++)
+        {
+            RegionAdd(regions, fill.region[r].start, fill.region[r].end,
+                      eRegionFill, fill.region[r].value);
+        }
+
+        RegionFree(&fill);
     }
 
-    if (!fp || !cpu)
+    if (find_text)
     {
-        fprintf(stderr,"%s\n", dasm_usage);
-        exit(EXIT_FAILURE);
+        region_list_t text = INIT_REGION_LIST;
+
+        RegionFindText(&text, seg->data, seg->size, seg->address,
+                       text_charset, text_run, text_bit7, regions);
+
+        for(r = 0; r < text.no; r++)
+        {
+            RegionAdd(regions, text.region[r].start, text.region[r].end,
+                      eRegionText, 0);
+        }
+
+        RegionFree(&text);
+    }
+
+    if (table_entries)
+    {
+        region_list_t table = INIT_REGION_LIST;
+
+        TableFind(&table, cpu, seg, table_entries, regions);
+
+        for(r = 0; r < table.no; r++)
+        {
+            RegionAdd(regions, table.region[r].start, table.region[r].end,
+                      eRegionTable, 0);
+        }
+
+        RegionFree(&table);
     }
+}
 
-    while(!feof(fp))
+/* Marks the targets of the words of a table in segment n, read in the
+   byte order of the CPU
+*/
+static void MarkTable(int n, const byte *data, ulong len, byte **target)
+{
+    ulong f;
+    int t;
+
+    for(f = 0; f + 1 < len; f += 2)
     {
-        address = cpu->disassemble(fp, address);
+        word w = GetWord(data + f, cpu->msb);
+
+        if ((t = LabelSegment(n, w)) != -1)
+        {
+            word off = w - label_img->segment[t].address;
+
+            target[t][off / 8] |= (byte)(1 << (off % 8));
+        }
     }
+}
+
+/* Finds the lines of every segment that are the target of a branch, jump
+   or call, or held in a table, decoding each segment the way it will be
+   listed.
+*/
+static void ScanLabels(const image_t *img)
+{
+    byte **target;
+    int n;
+
+    label_img = img;
+    label_bits = Alloc(NULL, sizeof *label_bits * (size_t)(img->no + 1));
+    target = Alloc(NULL, sizeof *target * (size_t)(img->no + 1));
+
+    for(n = 0; n < img->no; n++)
+    {
+        label_bits[n] = AllocClear(img->segment[n].size / 8 + 1);
+        target[n] = AllocClear(img->segment[n].size / 8 + 1);
+    }
+
+    /* label_bits holds where lines start until the targets are known
+    */
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+        region_list_t regions = INIT_REGION_LIST;
+        word address = seg->address;
+        ulong pos = 0;
+        int r = 0;
+
+        SegmentRegions(seg, &regions);
+
+        while(pos < seg->size)
+        {
+            const region_t *reg = r < regions.no ? regions.region + r : NULL;
+            decode_t d;
+            ulong len;
+            int t;
+
+            if (reg && address > reg->end)
+            {
+                r++;
+                continue;
+            }
+
+            label_bits[n][pos / 8] |= (byte)(1 << (pos % 8));
+
+            if (reg && address >= reg->start)
+            {
+                len = (ulong)(reg->end - address) + 1;
+
+                if (reg->type == eRegionTable)
+                {
+                    MarkTable(n, seg->data + pos, len, target);
+                }
+            }
+            else if (!(len = (ulong)cpu->decode(seg->data + pos,
+                                                seg->size - pos,
+                                                address, &d)))
+            {
+                break;
+            }
+            else if (d.has_target &&
+                     (t = LabelSegment(n, d.target)) != -1)
+            {
+                word off = d.target - img->segment[t].address;
+
+                target[t][off / 8] |= (byte)(1 << (off % 8));
+            }
+
+            pos += len;
+            address += (word)len;
+        }
+
+        RegionFree(&regions);
+    }
+
+    for(n = 0; n < img->no; n++)
+    {
+        ulong f;
+
+        for(f = 0; f <= img->segment[n].size / 8; f++)
+        {
+            label_bits[n][f] &= target[n][f];
+        }
+
+        free(target[n]);
+    }
+
+    free(target);
+}
+
+/* Moves through a segment without listing it, stopping at the line that
+   holds until or, if holding is FALSE, the first line that starts at or
+   after it.  Each line passed is added to build if it is not NULL.  With
+   track the cycles of the block being passed are kept as if it had been
+   listed.
+*/
+static word Advance(const region_list_t *regions, input_t *input,
+                    word address, word until, int holding, int track,
+                    index_t *build, int seg)
+{
+    int r = RegionNext(regions, address);
+
+    while(input->pos < input->size)
+    {
+        const region_t *reg = r < regions->no ? regions->region + r : NULL;
+        decode_t d;
+        ulong decoded;
+        ulong len;
+
+        if (reg && address > reg->end)
+        {
+            r++;
+            continue;
+        }
+
+        decoded = 0;
+
+        if (reg && address >= reg->start)
+        {
+            len = (ulong)(reg->end - address) + 1;
+        }
+        else if (!(len = decoded =
+                        (ulong)cpu->decode(input->data + input->pos,
+                                           input->size - input->pos,
+                                           address, &d)))
+        {
+            len = input->size - input->pos;
+        }
+
+        if (holding ? address + len > until : address >= until)
+        {
+            break;
+        }
+
+        if (build)
+        {
+            IndexAdd(build, seg, input->pos);
+        }
+
+        if (track && decoded)
+        {
+            if (block_no++ == 0)
+            {
+                block_start = address;
+            }
+
+            block_min += (ulong)d.cycles;
+            block_max += (ulong)d.cycles_max;
+
+            if (d.flow != eFlowNext)
+            {
+                ResetBlock();
+            }
+        }
+        else if (track && reg && address >= reg->start)
+        {
+            ResetBlock();
+        }
+
+        input->pos += len;
+        address += (word)len;
+    }
+
+    return address;
+}
+
+/* Lists the instructions that most likely lead up to the start address
+*/
+static void ListBackward(const segment_t *seg)
+{
+    static word start[BACKWARD_MAX];
+    int no;
+    int f;
+
+    no = Backward(cpu, seg->data, seg->size, seg->address, list_start,
+                  back_count, start);
+
+    for(f = 0; f < no && !PageFull(); f++)
+    {
+        word end = f + 1 < no ? start[f + 1] : list_start;
+        input_t input;
+
+        InputInit(&input, seg->data + (start[f] - seg->address),
+                  end - start[f]);
+        Step(&input, start[f]);
+        listed++;
+    }
+
+    EndBlock(list_start);
+}
+
+/* Lists the next line of a walk for the rendering stage of the pipeline.
+   Data regions are split into pieces that each start a whole number of
+   lines in, so that no line records more than PIPE_MAX_OUTPUT.
+*/
+static int ListLine(void *ctx)
+{
+    walk_t *w = ctx;
+
+    while(w->pos < w->seg->size)
+    {
+        const region_t *reg = w->r < w->regions->no ?
+                                        w->regions->region + w->r : NULL;
+        input_t input;
+
+        if (reg && w->address > reg->end)
+        {
+            w->r++;
+            continue;
+        }
+
+        InputInit(&input, w->seg->data + w->pos, w->seg->size - w->pos);
+
+        if (reg && w->address >= reg->start)
+        {
+            region_t part = *reg;
+            ulong len = (ulong)(reg->end - w->address) + 1;
+
+            if (reg->type != eRegionFill && reg->type != eRegionSkip &&
+                len > PIPE_DATA)
+            {
+                part.end = w->address + PIPE_DATA - 1;
+            }
+
+            if (w->last != w->r)
+            {
+                if ((list_count && w->lines >= list_count) ||
+                    w->pos >= w->stop)
+                {
+                    return FALSE;
+                }
+
+                w->lines++;
+            }
+
+            w->last = w->r;
+            w->end = ListRegion(&part, &input, w->address);
+        }
+        else
+        {
+            if ((list_count && w->lines >= list_count) || w->pos >= w->stop)
+            {
+                return FALSE;
+            }
+
+            w->end = Step(&input, w->address);
+            w->lines++;
+            w->last = -1;
+        }
+
+        w->pos += input.pos;
+        w->address = w->end;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Lists the lines of a segment that start from offset lo up to hi
+*/
+static void DisassembleSegment(const segment_t *seg, int n,
+                               ulong lo, ulong hi)
+{
+    region_list_t regions = INIT_REGION_LIST;
+    input_t input;
+    word address = seg->address;
+    int r = 0;
+
+    if (seg->size == 0)
+    {
+        return;
+    }
+
+    SegmentRegions(seg, &regions);
+
+    InputInit(&input, seg->data, seg->size);
+    label_seg = n;
+
+    if (start_set && back_count && list_start > seg->address)
+    {
+        ListBackward(seg);
+
+        input.pos = list_start - seg->address;
+        address = list_start;
+        r = RegionNext(&regions, address);
+    }
+    else if (start_set && list_start > seg->address)
+    {
+        if (use_index)
+        {
+            input.pos = IndexFind(&sidecar, n, list_start - seg->address);
+            address += (word)input.pos;
+        }
+
+        address = Advance(&regions, &input, address, list_start,
+                          TRUE, FALSE, NULL, n);
+        r = RegionNext(&regions, address);
+    }
+    else if (lo > 0)
+    {
+        /* A checkpoint would lose the cycles of the block that crosses
+           into the shard.
+        */
+        if (use_index && !timing)
+        {
+            input.pos = IndexFind(&sidecar, n, lo);
+            address += (word)input.pos;
+        }
+
+        address = Advance(&regions, &input, address, seg->address + lo,
+                          FALSE, timing, NULL, n);
+        r = RegionNext(&regions, address);
+    }
+
+    if (pipelined)
+    {
+        walk_t w;
+
+        w.seg = seg;
+        w.regions = &regions;
+        w.pos = input.pos;
+        w.address = address;
+        w.r = r;
+        w.last = -1;
+        w.stop = hi;
+        w.lines = listed;
+        w.end = address;
+
+        if (Pipeline(ListLine, &w))
+        {
+            address = w.end;
+            listed = w.lines;
+            input.eof = TRUE;
+        }
+    }
+
+    while(!InputEOF(&input) && !PageFull() && input.pos < hi)
+    {
+        const region_t *reg = r < regions.no ? regions.region + r : NULL;
+
+        if (reg && address >= reg->start)
+        {
+            /* An instruction may have run into the region, in which case
+               only the rest of it is listed.
+            */
+            if (address <= reg->end)
+            {
+                address = ListRegion(reg, &input, address);
+                listed++;
+            }
+
+            r++;
+        }
+        else
+        {
+            address = Step(&input, address);
+            listed++;
+        }
+    }
+
+    /* A block running on past hi is ended by the next shard
+    */
+    if (hi == seg->size)
+    {
+        EndBlock(address);
+    }
+
+    RegionFree(&regions);
+}
+
+/* Writes an index of where the lines of every segment start
+*/
+static int WriteIndex(const image_t *img, word origin)
+{
+    int n;
+    int ok;
+
+    IndexInit(&sidecar, cpu->name, origin, index_spacing, img,
+              OptionsHash());
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+        region_list_t regions = INIT_REGION_LIST;
+        input_t input;
+
+        SegmentRegions(seg, &regions);
+        InputInit(&input, seg->data, seg->size);
+        Advance(&regions, &input, seg->address, seg->address + seg->size,
+                TRUE, FALSE, &sidecar, n);
+        RegionFree(&regions);
+    }
+
+    ok = IndexWrite(&sidecar, index_out);
+    IndexFree(&sidecar);
+
+    return ok;
+}
+
+/* Opens the index given with -i, ignoring it if the image has changed
+*/
+static void ReadIndex(const image_t *img, word origin)
+{
+    index_t template;
+
+    if (!IndexLoad(&sidecar, index_in))
+    {
+        return;
+    }
+
+    IndexInit(&template, cpu->name, origin, index_spacing, img,
+              OptionsHash());
+
+    if (IndexMatches(&sidecar, &template))
+    {
+        use_index = TRUE;
+    }
+    else
+    {
+        fprintf(stderr, "dasm: index %s does not match the image, "
+                        "ignored\n", index_in);
+        IndexFree(&sidecar);
+    }
+
+    IndexFree(&template);
+}
+
+/* Writes the entropy map of every segment in the form -M reads, with the
+   figures for each region in a comment
+*/
+static void WriteEntropyMap(const image_t *img)
+{
+    ulong mask = (1UL << (cpu->digits * 4)) - 1;
+    int n;
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+        entropy_t *e;
+        ulong no = EntropyMap(cpu, seg->data, seg->size, seg->address, &e);
+        ulong f;
+
+        if (seg->bank != NO_BANK)
+        {
+            printf("; bank %d at $%4.4x\n", seg->bank, seg->address);
+        }
+        else if (img->no > 1)
+        {
+            printf("; segment at $%4.4x\n", seg->address);
+        }
+
+        for(f = 0; f < no; f++)
+        {
+            word start = (word)((seg->address + e[f].pos) & mask);
+            word end = (word)((start + e[f].size - 1) & mask);
+
+            printf("%.*x-%.*x   %-6s; %.2f bits, %.1f%% illegal, "
+                   "%.0f%% text\n", cpu->digits, start, cpu->digits, end,
+                   RegionTypeName(e[f].type), e[f].entropy,
+                   e[f].illegal * 100, e[f].text * 100);
+        }
+
+        free(e);
+    }
+}
+
+/* Adds the fingerprints of the files from argv[f] on to the database given
+   with -F, which is made if it does not exist yet.  Databases among the
+   files are merged into it.
+*/
+static int AddFingerprints(int argc, char *argv[], int f, word origin)
+{
+    fingerprint_t db;
+    fingerprint_t other;
+    image_t img;
+    FILE *fp;
+    int ok = TRUE;
+
+    FingerprintInit(&db, cpu->name);
+
+    if ((fp = fopen(fingerprint_out, "rb")))
+    {
+        fclose(fp);
+
+        if (!FingerprintLoad(&other, fingerprint_out))
+        {
+            return FALSE;
+        }
+
+        ok = FingerprintMerge(&db, &other);
+        FingerprintFree(&other);
+    }
+
+    for(; ok && f < argc; f++)
+    {
+        if (!ImageOpen(&img, argv[f]))
+        {
+            fprintf(stderr, "dasm: cannot read %s\n", argv[f]);
+            ok = FALSE;
+        }
+        else if (FingerprintIsDatabase(img.file, img.file_size))
+        {
+            ImageClose(&img);
+
+            ok = FingerprintLoad(&other, argv[f]) &&
+                 FingerprintMerge(&db, &other);
+
+            FingerprintFree(&other);
+        }
+        else
+        {
+            if (!LoadImage(&img, argv[f], origin))
+            {
+                ok = FALSE;
+            }
+            else if (!FingerprintAdd(&db, cpu, &img, argv[f]))
+            {
+                fprintf(stderr, "dasm: %s is already in %s\n", argv[f],
+                        fingerprint_out);
+            }
+
+            ImageClose(&img);
+        }
+    }
+
+    if (ok && !FingerprintWrite(&db, fingerprint_out))
+    {
+        fprintf(stderr, "dasm: cannot write fingerprints %s\n",
+                fingerprint_out);
+        ok = FALSE;
+    }
+
+    FingerprintFree(&db);
+
+    return ok;
+}
+
+/* Looks for the routine at -s, or the start of the image, in the database
+   given with -Q
+*/
+static int QueryFingerprints(const image_t *img)
+{
+    fingerprint_t db;
+    word start = start_set || img->no == 0 ? list_start :
+                                             img->segment[0].address;
+    int ok = FALSE;
+    int n;
+
+    if (!FingerprintLoad(&db, fingerprint_in))
+    {
+        return FALSE;
+    }
+
+    if (!StrEqual(db.cpu, cpu->name))
+    {
+        fprintf(stderr, "dasm: %s holds %s fingerprints\n", fingerprint_in,
+                db.cpu);
+        FingerprintFree(&db);
+        return FALSE;
+    }
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+
+        if (start >= seg->address && start - seg->address < seg->size)
+        {
+            ulong pos = start - seg->address;
+
+            ok = TRUE;
+
+            if (!FingerprintQuery(&db, cpu, seg->data + pos, seg->size - pos,
+                                  start, list_count))
+            {
+                fprintf(stderr, "dasm: routine at $%4.4x is too short to "
+                                "fingerprint\n", (unsigned)start);
+                ok = FALSE;
+            }
+
+            break;
+        }
+    }
+
+    if (n == img->no)
+    {
+        fprintf(stderr, "dasm: $%4.4x is not in the image\n",
+                (unsigned)start);
+    }
+
+    FingerprintFree(&db);
+
+    return ok;
+}
+
+/* Adds the instructions of the files from argv[f] on to the index given
+   with -I, which is made if it does not exist yet.  Indexes among the files
+   are merged into it.
+*/
+static int AddInstructions(int argc, char *argv[], int f, word origin)
+{
+    search_t db;
+    search_t other;
+    image_t img;
+    FILE *fp;
+    int ok = TRUE;
+
+    SearchInit(&db, cpu->name);
+
+    if ((fp = fopen(search_db, "rb")))
+    {
+        fclose(fp);
+
+        if (!SearchLoad(&other, search_db))
+        {
+            return FALSE;
+        }
+
+        ok = SearchMerge(&db, &other);
+        SearchFree(&other);
+    }
+
+    for(; ok && f < argc; f++)
+    {
+        if (!ImageOpen(&img, argv[f]))
+        {
+            fprintf(stderr, "dasm: cannot read %s\n", argv[f]);
+            ok = FALSE;
+        }
+        else if (img.file_size >= 4 && memcmp(img.file, "DINV", 4) == 0)
+        {
+            ImageClose(&img);
+
+            ok = SearchLoad(&other, argv[f]) && SearchMerge(&db, &other);
+
+            SearchFree(&other);
+        }
+        else
+        {
+            if (!LoadImage(&img, argv[f], origin))
+            {
+                ok = FALSE;
+            }
+            else if (!SearchAdd(&db, cpu, &img, argv[f]))
+            {
+                fprintf(stderr, "dasm: %s is already in %s\n", argv[f],
+                        search_db);
+            }
+
+            ImageClose(&img);
+        }
+    }
+
+    if (ok && !SearchWrite(&db, search_db))
+    {
+        fprintf(stderr, "dasm: cannot write index %s\n", search_db);
+        ok = FALSE;
+    }
+
+    SearchFree(&db);
+
+    return ok;
+}
+
+/* Turns the term given with -q into the opcode and operand to look for.  A
+   number starting with $ or 0x is an operand.  Anything else is the bytes
+   of an instruction in hex, which match its opcode and, if they hold all
+   of it, its operand too unless that depends on where it is.
+*/
+static int ParseTerm(long *opcode, long *operand)
+{
+    byte b[MAX_MEMORY_BUFFER];
+    const char *p = search_term;
+    decode_t d;
+    decode_t moved;
+    int no = 0;
+    int len;
+
+    *opcode = -1;
+    *operand = -1;
+
+    /* An operand is up to 8 hex digits and nothing else
+    */
+    if (*p == '$' || (p[0] == '0' && tolower((unsigned char)p[1]) == 'x'))
+    {
+        const char *digits = p + (*p == '$' ? 1 : 2);
+
+        for(p = digits, *operand = 0; hex_value[(byte)*p] >= 0; p++)
+        {
+            *operand = *operand << 4 | hex_value[(byte)*p];
+        }
+
+        return p > digits && p - digits <= 8 && !*p;
+    }
+
+    while(*p && no < MAX_MEMORY_BUFFER)
+    {
+        char hex[3];
+
+        if (isspace((unsigned char)*p))
+        {
+            p++;
+            continue;
+        }
+
+        if (!isxdigit((unsigned char)p[0]) || !isxdigit((unsigned char)p[1]))
+        {
+            return FALSE;
+        }
+
+        hex[0] = *p++;
+        hex[1] = *p++;
+        hex[2] = 0;
+        b[no++] = (byte)strtoul(hex, NULL, 16);
+    }
+
+    if (no == 0)
+    {
+        return FALSE;
+    }
+
+    if ((len = cpu->decode(b, (ulong)no, 0, &d)) == 0)
+    {
+        /* Only the start of the instruction, so any operand will do
+        */
+        memset(b + no, 0, sizeof b - (size_t)no);
+
+        if (!cpu->decode(b, sizeof b, 0, &d))
+        {
+            return FALSE;
+        }
+
+        d.has_operand = FALSE;
+    }
+    else if (len != no)
+    {
+        return FALSE;
+    }
+    else if (d.has_operand && cpu->decode(b, (ulong)no, 0x1000, &moved) &&
+             moved.operand != d.operand)
+    {
+        d.has_operand = FALSE;
+    }
+
+    *opcode = (long)((d.page & 0xff) << 8 | (d.opcode & 0xff));
+    *operand = d.has_operand ? (long)d.operand : -1;
+
+    return TRUE;
+}
+
+/* Lists the instructions in the index given with -I that match -q
+*/
+static int Search(void)
+{
+    search_t db;
+    long opcode;
+    long operand;
+    int ok = TRUE;
+
+    if (!SearchLoad(&db, search_db))
+    {
+        return FALSE;
+    }
+
+    if (!cpu)
+    {
+        cpu = FindCPU(db.cpu);
+    }
+
+    if (!cpu || !StrEqual(db.cpu, cpu->name))
+    {
+        fprintf(stderr, "dasm: %s holds %s instructions\n", search_db,
+                db.cpu);
+        ok = FALSE;
+    }
+    else if (!ParseTerm(&opcode, &operand))
+    {
+        fprintf(stderr, "dasm: cannot search for %s\n", search_term);
+        ok = FALSE;
+    }
+    else
+    {
+        SearchQuery(&db, opcode, operand, list_count, stdout);
+    }
+
+    SearchFree(&db);
+
+    return ok;
+}
+
+/* Disassembles the current member of the archive as a raw binary at
+   address, a chunk at a time.  Returns FALSE if it could not all be read.
+*/
+static int DisassembleMember(word address)
+{
+    static byte buff[MAX_MEMORY_BUFFER + STREAM_CHUNK];
+    ulong held = 0;
+    input_t input;
+    long n;
+
+    while((n = ArchiveRead(&archive, buff + held, sizeof buff - held)) > 0)
+    {
+        ulong used;
+
+        held += (ulong)n;
+        used = FollowDecode(cpu, buff, held, &address, Step);
+
+        held -= used;
+        memmove(buff, buff + used, held);
+    }
+
+    /* Anything left is an instruction cut off by the end of the member
+    */
+    if (held)
+    {
+        InputInit(&input, buff, held);
+
+        while(!InputEOF(&input))
+        {
+            address = Step(&input, address);
+        }
+    }
+
+    EndBlock(address);
+
+    return n == 0;
+}
+
+
+/* ---------------------------------------- MAIN
+*/
+int main(int argc, char *argv[])
+{
+    image_t img;
+    ulong base = 0;
+    int opened = FALSE;
+    int status = EXIT_SUCCESS;
+    word address = 0;
+    int f;
+    int n;
+
+    M68K_Init();
+    OutputOption(eShowAddress, 1);
+    OutputOption(eShowMemory, 1);
+
+    for(f = 1; f < argc && argv[f][0] == '-'; f++)
+    {
+        switch(argv[f][1])
+        {
+            case 'c':
+                auto_cpu = StrEqual(argv[f+1], "auto");
+                cpu = FindCPU(argv[f+1]);
+                f++;
+                break;
+
+            case 'o':
+                address = (word)strtol(argv[++f], NULL, 0);
+                break;
+
+            case 'a':
+                OutputOption(eShowAddress, 0);
+                break;
+
+            case 'm':
+                OutputOption(eShowMemory, 0);
+                break;
+
+            case 'u':
+                OutputOption(eUppercase, 1);
+                break;
+
+            case 'f':
+                follow = TRUE;
+                break;
+
+            case 'T':
+                trace = TRUE;
+                break;
+
+            case 't':
+                timing = TRUE;
+                break;
+
+            case 'M':
+                if (!RegionLoad(&map, argv[++f]))
+                {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'r':
+                fill_run = strtoul(argv[++f], NULL, 0);
+                break;
+
+            case 'E':
+                if (!ParseCharset(argv[++f]))
+                {
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'H':
+                text_bit7 = TRUE;
+                break;
+
+            case 'j':
+                table_entries = strtoul(argv[++f], NULL, 0);
+                break;
+
+            case 'e':
+                entropy_map = TRUE;
+                break;
+
+            case 'z':
+                skip_random = TRUE;
+                break;
+
+            case 'g':
+                graph = argv[++f];
+                break;
+
+            case 'W':
+                index_out = argv[++f];
+                break;
+
+            case 'k':
+                index_spacing = strtoul(argv[++f], NULL, 0);
+                break;
+
+            case 'i':
+                index_in = argv[++f];
+                break;
+
+            case 'F':
+                fingerprint_out = argv[++f];
+                break;
+
+            case 'Q':
+                fingerprint_in = argv[++f];
+                break;
+
+            case 'S':
+                opcode_stats = TRUE;
+                break;
+
+            case 'I':
+                search_db = argv[++f];
+                break;
+
+            case 'q':
+                search_term = argv[++f];
+                break;
+
+            case 'l':
+                labels = TRUE;
+                break;
+
+            case 's':
+                start_set = TRUE;
+                list_start = (word)strtoul(argv[++f], NULL, 0);
+                break;
+
+            case 'n':
+                list_count = strtoul(argv[++f], NULL, 0);
+                break;
+
+            case 'b':
+                back_count = atoi(argv[++f]);
+                break;
+
+            case 'P':
+                pipelined = TRUE;
+                break;
+
+            case 'p':
+                if (!(profile = ProfileLoad(argv[++f])))
+                {
+                    exit(EXIT_FAILURE);
+                }
+
+                OutputProfile(profile);
+                break;
+
+            case '-':
+                if (StrEqual(argv[f], "--follow"))
+                {
+                    follow = TRUE;
+                }
+                else if (StrEqual(argv[f], "--shard"))
+                {
+                    if (++f == argc || !ShardParse(argv[f]))
+                    {
+                        fprintf(stderr, "dasm: --shard needs i/n with "
+                                        "1 <= i <= n\n");
+                        exit(EXIT_FAILURE);
+                    }
+                }
+                break;
+
+            case 'd':
+                f++;
+
+                if (StrEqual(argv[f], "ca65"))
+                {
+                    OutputOption(eDialect, eDialectCa65);
+                }
+                else if (StrEqual(argv[f], "devpac"))
+                {
+                    OutputOption(eDialect, eDialectDevpac);
+                }
+                else if (StrEqual(argv[f], "db"))
+                {
+                    OutputOption(eDialect, eDialectDb);
+                }
+                else
+                {
+                    fprintf(stderr, "dasm: unknown dialect %s\n", argv[f]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'x':
+                f++;
+
+                if (StrEqual(argv[f], "0x"))
+                {
+                    OutputOption(eHexStyle, eHexC);
+                }
+                else if (StrEqual(argv[f], "h"))
+                {
+                    OutputOption(eHexStyle, eHexSuffix);
+                }
+                else
+                {
+                    OutputOption(eHexStyle, eHexDollar);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (shard_count && (start_set || list_count || back_count || profile))
+    {
+        fprintf(stderr, "dasm: --shard cannot be used with -s, -n, -b "
+                        "or -p\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (follow && labels)
+    {
+        fprintf(stderr, "dasm: -l cannot be used with -f\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (search_db && search_term)
+    {
+        return Search() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (f < argc && ImageOpen(&img, argv[f]))
+    {
+        opened = TRUE;
+
+        if (!trace && !follow && !graph && !entropy_map && !index_out &&
+            !fingerprint_out && !fingerprint_in && !opcode_stats &&
+            !search_db && ArchiveOpen(&archive, img.file, img.file_size))
+        {
+            if (shard_count)
+            {
+                fprintf(stderr, "dasm: --shard cannot be used with "
+                                "archives\n");
+                exit(EXIT_FAILURE);
+            }
+
+            if (fill_run || find_text || table_entries || skip_random ||
+                map.no || start_set || list_count || back_count ||
+                index_in || labels || profile)
+            {
+                fprintf(stderr, "dasm: -r, -E, -j, -z, -M, -s, -n, -b, -i, "
+                                "-l and -p cannot be used with archives\n");
+                exit(EXIT_FAILURE);
+            }
+
+            archived = TRUE;
+        }
+        else if (!trace && !LoadImage(&img, argv[f], address))
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (archived && !cpu && auto_cpu)
+    {
+        byte *sample = Alloc(NULL, DETECT_SAMPLE);
+        ulong len;
+
+        if ((len = ArchiveSample(sample, DETECT_SAMPLE)) > 0)
+        {
+            Detect(sample, len, address);
+        }
+
+        free(sample);
+    }
+
+    if (opened && !cpu && auto_cpu && img.no > 0)
+    {
+        ulong len = img.segment[0].size;
+
+        if (len > DETECT_SAMPLE)
+        {
+            len = DETECT_SAMPLE;
+        }
+
+        Detect(img.segment[0].data, len, img.segment[0].address);
+    }
+
+    if (opened && !cpu && img.cpu)
+    {
+        cpu = FindCPU(img.cpu);
+    }
+
+    if (!opened || !cpu)
+    {
+        fprintf(stderr,"%s\n", dasm_usage);
+        exit(EXIT_FAILURE);
+    }
+
+    if (trace)
+    {
+        int ok = Trace(cpu, img.file, img.file_size);
+
+        ImageClose(&img);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (follow)
+    {
+        ImageClose(&img);
+
+        if (!Follow(cpu, argv[f], address, Step))
+        {
+            fprintf(stderr, "dasm: cannot follow %s\n", argv[f]);
+            exit(EXIT_FAILURE);
+        }
+
+        return EXIT_SUCCESS;
+    }
+
+    if (graph)
+    {
+        cfg_t cfg;
+
+        CFGBuild(&cfg, cpu, &img);
+
+        if (StrEqual(graph, "bin"))
+        {
+            CFGWriteBinary(&cfg, stdout);
+        }
+        else
+        {
+            CFGWriteDot(&cfg, stdout);
+        }
+
+        CFGFree(&cfg);
+        ImageClose(&img);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (entropy_map)
+    {
+        WriteEntropyMap(&img);
+        ImageClose(&img);
+
+        return EXIT_SUCCESS;
+    }
+
+    if (index_out)
+    {
+        int ok = WriteIndex(&img, address);
+
+        if (!ok)
+        {
+            fprintf(stderr, "dasm: cannot write index %s\n", index_out);
+        }
+
+        ImageClose(&img);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (opcode_stats)
+    {
+        ImageClose(&img);
+
+        return Stats(cpu, argv + f, argc - f, address, stdout) ?
+                                            EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (search_db)
+    {
+        int ok;
+
+        ImageClose(&img);
+        ok = AddInstructions(argc, argv, f, address);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (fingerprint_out)
+    {
+        int ok;
+
+        ImageClose(&img);
+        ok = AddFingerprints(argc, argv, f, address);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (fingerprint_in)
+    {
+        int ok = QueryFingerprints(&img);
+
+        ImageClose(&img);
+
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (index_in)
+    {
+        ReadIndex(&img, address);
+    }
+
+    if (profile)
+    {
+        ProfileWeigh(profile, cpu, &img);
+    }
+
+    while(archived && ArchiveNext(&archive))
+    {
+        OutputComment("%s member %#s", archive.format, archive.name);
+
+        if (!DisassembleMember(address))
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    if (shard_count)
+    {
+        ShardSplit(&img);
+    }
+
+    if (labels)
+    {
+        ScanLabels(&img);
+        OutputWordLabels(IsLabel);
+    }
+
+    if (img.has_entry && !start_set && ShardOwns(0))
+    {
+        OutputComment("%s, entry point $%4.4x", img.format, img.entry);
+    }
+
+    for(n = 0; n < img.no && !PageFull(); base += img.segment[n++].size)
+    {
+        const segment_t *seg = img.segment + n;
+        ulong lo = 0;
+        ulong hi = seg->size;
+
+        if (start_set && seg->address + seg->size <= list_start)
+        {
+            continue;
+        }
+
+        if (shard_count)
+        {
+            lo = shard_lo > base ? shard_lo - base : 0;
+            hi = shard_hi < base ? 0 :
+                 shard_hi < base + hi ? shard_hi - base : hi;
+        }
+
+        /* The header of a segment goes with the shard that starts it
+        */
+        if (ShardOwns(base) && seg->bank != NO_BANK)
+        {
+            OutputComment("bank %u at $%4.4x", seg->bank, seg->address);
+        }
+        else if (ShardOwns(base) && img.no > 1)
+        {
+            if (n > 0 && seg[-1].address + seg[-1].size < seg->address)
+            {
+                OutputComment("gap $%4.4x-$%4.4x",
+                              seg[-1].address + seg[-1].size,
+                              seg->address - 1);
+            }
+
+            OutputComment("segment at $%4.4x", seg->address);
+        }
+
+        if (lo < hi)
+        {
+            DisassembleSegment(seg, n, lo, hi);
+        }
+    }
+
+    if (use_index)
+    {
+        IndexFree(&sidecar);
+    }
+
+    if (label_bits)
+    {
+        for(n = 0; n < img.no; n++)
+        {
+            free(label_bits[n]);
+        }
+
+        free(label_bits);
+    }
+
+    if (profile)
+    {
+        ProfileSummary(profile, HOT_RANGES);
+        ProfileFree(profile);
+    }
+
+    ImageClose(&img);
 
-    return EXIT_SUCCESS;
+    return status;
 }
 
 
@@ -0,0 +1,122 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Decoding interface shared by the processors.
+
+    Alongside the text disassembler each processor supplies a decoder that
+    works on a memory buffer and fills in a decode_t without producing any
+    text, for use by analysis passes.
+
+*/
+
+#ifndef DASM_DECODE_H
+#define DASM_DECODE_H
+
+#include "global.h"
+#include "input.h"
+
+/* Terminates a model list
+*/
+#define MODEL_END       0xffff
+
+/* Longest instruction of any CPU, in bytes
+*/
+#define MAX_INSTRUCTION 10
+
+/* How an instruction affects the flow of control
+*/
+typedef enum
+{
+    eFlowNext,          /* Falls through to the next instruction */
+    eFlowBranch,        /* Conditional branch to target */
+    eFlowJump,          /* Unconditional jump to target */
+    eFlowCall,          /* Subroutine call or software interrupt */
+    eFlowReturn,        /* Return from subroutine or interrupt */
+    eFlowIndirect,      /* Jump through a register or memory */
+    eFlowHalt           /* Halt or jam */
+} flow_t;
+
+/* A decoded instruction
+*/
+typedef struct
+{
+    word        address;        /* Address of the instruction */
+    int         length;         /* Length in bytes */
+    int         page;           /* Opcode page (prefix), processor specific */
+    int         opcode;         /* Opcode within the page */
+    int         illegal;        /* Illegal, undocumented or jam opcode */
+    flow_t      flow;           /* Effect on the flow of control */
+    int         conditional;    /* Conditional call or return */
+    int         has_target;     /* TRUE if target is set */
+    word        target;         /* Static branch, jump or call target */
+    int         has_operand;    /* TRUE if operand is set */
+    word        operand;        /* The address or value the instruction
+                                   uses, or its target */
+    int         cycles;         /* Cycles or T-states, at the least */
+    int         cycles_max;     /* Cycles if a branch is taken, a condition
+                                   met, a block instruction repeats or an
+                                   index crosses a page */
+} decode_t;
+
+/* Defines a CPU
+*/
+typedef struct
+{
+    const char          *name;
+    word                (*disassemble)(input_t *input, word address);
+
+    /* Decodes the instruction at data, returning its length or zero if size
+       does not hold the whole instruction.
+    */
+    int                 (*decode)(const byte *data, ulong size, word address,
+                                  decode_t *decode);
+
+    /* The most common instructions in typical code as (page << 8 | opcode),
+       most frequent first and terminated with MODEL_END.
+    */
+    const word          *model;
+
+    /* Fills entry with up to max likely entry points of an image, returning
+       the number found.
+    */
+    int                 (*entries)(const byte *data, ulong size, word origin,
+                                   word *entry, int max);
+
+    /* Hex digits shown in an address
+    */
+    int                 digits;
+
+    /* TRUE if words are stored high byte first
+    */
+    int                 msb;
+
+    /* Longest instruction in bytes, at most MAX_INSTRUCTION, and the
+       alignment in bytes of every instruction's address
+    */
+    int                 max_length;
+    int                 align;
+} CPU;
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
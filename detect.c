@@ -0,0 +1,274 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    CPU auto-detection.
+
+    Each CPU sweeps the sample and is scored on how well the opcodes it sees
+    fit its frequency model, how many illegal opcodes it meets, how many of
+    its branch targets land on its own instruction boundaries and whether
+    its vectors point at code.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "detect.h"
+#include "util.h"
+
+#define MAX_ENTRIES     16
+#define MAX_CPUS        16
+
+/* Share of all instructions the model's listed opcodes are expected to
+   cover.
+*/
+#define MODEL_MASS      0.75
+
+/* Weights of the individual measures
+*/
+#define W_ILLEGAL       6.0
+#define W_BRANCH        2.0
+#define W_VECTOR        1.0
+
+/* Sharpness of the conversion of scores to a confidence
+*/
+#define CONFIDENCE_K    4.0
+
+/* Score random bytes typically reach on the best CPU.  This is included as
+   a "not code" candidate when calculating the confidence.
+*/
+#define DATA_SCORE      1.0
+
+/* Instructions decoded at each entry point when checking vectors
+*/
+#define VECTOR_DEPTH    4
+
+
+void DetectModel(const word *model, double *llr)
+{
+    double harmonic = 0;
+    double unlisted;
+    int no;
+    int f;
+
+    for(no = 0; model[no] != MODEL_END; no++)
+    {
+        harmonic += 1.0 / (no + 1);
+    }
+
+    unlisted = log((1.0 - MODEL_MASS) * 256.0 / (no < 256 ? 256 - no : 1)) /
+                    log(2.0);
+
+    for(f = 0; f < MODEL_KEYS; f++)
+    {
+        llr[f] = unlisted;
+    }
+
+    for(f = 0; f < no; f++)
+    {
+        if (model[f] < MODEL_KEYS)
+        {
+            llr[model[f]] = log(MODEL_MASS / (f + 1) / harmonic * 256.0) /
+                                log(2.0);
+        }
+    }
+}
+
+static int Inside(word address, word origin, ulong size)
+{
+    return address >= origin && address - origin < size;
+}
+
+static double VectorScore(const CPU *cpu, const byte *data, ulong size,
+                          word origin)
+{
+    word entry[MAX_ENTRIES];
+    int valid = 0;
+    int total = 0;
+    int no;
+    int f;
+
+    no = cpu->entries(data, size, origin, entry, MAX_ENTRIES);
+
+    for(f = 0; f < no; f++)
+    {
+        word address = entry[f];
+        int ok;
+        int n;
+
+        if (address == origin)
+        {
+            continue;
+        }
+
+        total++;
+        ok = Inside(address, origin, size);
+
+        for(n = 0; ok && n < VECTOR_DEPTH; n++)
+        {
+            decode_t d;
+            ulong off = address - origin;
+            int len;
+
+            len = cpu->decode(data + off, size - off, address, &d);
+
+            if (len == 0)
+            {
+                break;
+            }
+
+            ok = !d.illegal;
+            address += len;
+        }
+
+        valid += ok;
+    }
+
+    return total ? (double)valid / total : 0.0;
+}
+
+static double Score(const CPU *cpu, const byte *data, ulong size, word origin,
+                    byte *boundary)
+{
+    static double llr[MODEL_KEYS];
+    double sum = 0;
+    double score;
+    ulong off;
+    long no = 0;
+    long illegal = 0;
+    long valid = 0;
+    long invalid = 0;
+
+    DetectModel(cpu->model, llr);
+
+    memset(boundary, 0, size);
+
+    for(off = 0; off < size;)
+    {
+        decode_t d;
+        int len;
+        int key;
+
+        len = cpu->decode(data + off, size - off, origin + off, &d);
+
+        if (len == 0)
+        {
+            break;
+        }
+
+        key = d.page << 8 | d.opcode;
+
+        sum += key < MODEL_KEYS ? llr[key] : llr[0];
+        illegal += d.illegal;
+        no++;
+
+        boundary[off] = 1;
+        off += len;
+    }
+
+    /* Second pass to check where the branches land
+    */
+    for(off = 0; off < size;)
+    {
+        decode_t d;
+        int len;
+
+        len = cpu->decode(data + off, size - off, origin + off, &d);
+
+        if (len == 0)
+        {
+            break;
+        }
+
+        if (d.has_target && Inside(d.target, origin, size))
+        {
+            if (boundary[d.target - origin])
+            {
+                valid++;
+            }
+            else
+            {
+                invalid++;
+            }
+        }
+
+        off += len;
+    }
+
+    if (no == 0)
+    {
+        return -W_ILLEGAL;
+    }
+
+    score = sum / no - W_ILLEGAL * illegal / no;
+
+    if (valid + invalid)
+    {
+        score += W_BRANCH * valid / (valid + invalid);
+    }
+
+    score += W_VECTOR * VectorScore(cpu, data, size, origin);
+
+    return score;
+}
+
+const CPU *DetectCPU(const CPU *table, const byte *data, ulong size,
+                     word origin, int *confidence)
+{
+    double score[MAX_CPUS];
+    double total;
+    double best_score = 0.0;
+    byte *boundary;
+    int best = 0;
+    int f;
+
+    boundary = Alloc(NULL, size);
+
+    for(f = 0; f < MAX_CPUS && table[f].name; f++)
+    {
+        score[f] = Score(table + f, data, size, origin, boundary);
+
+        if (f == 0 || score[f] > best_score)
+        {
+            best = f;
+            best_score = score[f];
+        }
+    }
+
+    free(boundary);
+
+    total = exp(CONFIDENCE_K * (DATA_SCORE - best_score));
+
+    while(f--)
+    {
+        total += exp(CONFIDENCE_K * (score[f] - best_score));
+    }
+
+    *confidence = (int)(100.0 / total + 0.5);
+
+    return table + best;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,52 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    CPU auto-detection.
+
+*/
+
+#ifndef DASM_DETECT_H
+#define DASM_DETECT_H
+
+#include "global.h"
+#include "decode.h"
+
+/* Opcode keys (page << 8 | opcode) covered by a model
+*/
+#define MODEL_KEYS      (8 * 256)
+
+/* Scores every CPU in the NULL terminated table against a sample of an
+   image and returns the most likely one.  The confidence in the choice as a
+   percentage is returned in confidence.
+*/
+const CPU *DetectCPU(const CPU *table, const byte *data, ulong size,
+                     word origin, int *confidence);
+
+/* Builds the log2 likelihood ratio of each opcode key under a CPU's model
+   against a uniform byte distribution.  llr must hold MODEL_KEYS values.
+*/
+void DetectModel(const word *model, double *llr);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
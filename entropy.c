@@ -0,0 +1,273 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Entropy maps.
+
+    A linear sweep first marks where instructions start and which are
+    illegal.  A window of ENTROPY_WINDOW bytes then slides over the data,
+    centred on each block in turn.  The window keeps a histogram of its
+    bytes along with the sum of c * log2(c) over it, its instructions,
+    illegal instructions and printable bytes, and each byte that enters or
+    leaves the window changes these by a table lookup, so the whole map
+    takes time linear in the data.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "entropy.h"
+#include "util.h"
+
+/* Bits per byte above which a window is taken to be compressed or
+   encrypted, and above which it also is if it has many illegal
+   instructions.  Even random bytes come to little more than 7.2 bits in a
+   window of 256.
+*/
+#define HIGH_ENTROPY    6.9
+#define MIXED_ENTROPY   6.2
+#define HIGH_ILLEGAL    0.2
+
+/* Share of printable bytes above which a window is text
+*/
+#define TEXT_SHARE      0.9
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    const byte  *data;
+    ulong       lo;                     /* The window is lo to hi - 1 */
+    ulong       hi;
+    ulong       count[256];
+    double      sum;                    /* Of c * log2(c) over count */
+    ulong       starts;
+    ulong       illegal;
+    ulong       printable;
+    byte        *start;                 /* Bit set where a line starts */
+    byte        *bad;                   /* Bit set on illegal ones */
+} window_t;
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static double plogp[ENTROPY_WINDOW + 1];
+static byte printable[256];
+static int built;
+
+
+/* ---------------------------------------- UTILS
+*/
+static void Build(void)
+{
+    int f;
+
+    for(f = 1; f <= ENTROPY_WINDOW; f++)
+    {
+        plogp[f] = f * log2((double)f);
+    }
+
+    for(f = 0x20; f < 0x7f; f++)
+    {
+        printable[f] = 1;
+    }
+
+    printable['\t'] = 1;
+    printable['\n'] = 1;
+    printable['\r'] = 1;
+
+    built = TRUE;
+}
+
+static int Bit(const byte *bits, ulong pos)
+{
+    return (bits[pos / 8] >> (pos % 8)) & 1;
+}
+
+static void SetBit(byte *bits, ulong pos)
+{
+    bits[pos / 8] |= (byte)(1 << (pos % 8));
+}
+
+static void Sweep(window_t *w, const CPU *cpu, ulong size, word address)
+{
+    ulong pos = 0;
+
+    while(pos < size)
+    {
+        decode_t d;
+        ulong len;
+
+        if (!(len = (ulong)cpu->decode(w->data + pos, size - pos,
+                                       address, &d)))
+        {
+            break;
+        }
+
+        SetBit(w->start, pos);
+
+        if (d.illegal)
+        {
+            SetBit(w->bad, pos);
+        }
+
+        pos += len;
+        address += (word)len;
+    }
+}
+
+static void Enter(window_t *w)
+{
+    ulong pos = w->hi++;
+    ulong *c = w->count + w->data[pos];
+
+    w->sum += plogp[*c + 1] - plogp[*c];
+    (*c)++;
+    w->starts += Bit(w->start, pos);
+    w->illegal += Bit(w->bad, pos);
+    w->printable += printable[w->data[pos]];
+}
+
+static void Leave(window_t *w)
+{
+    ulong pos = w->lo++;
+    ulong *c = w->count + w->data[pos];
+
+    w->sum += plogp[*c - 1] - plogp[*c];
+    (*c)--;
+    w->starts -= Bit(w->start, pos);
+    w->illegal -= Bit(w->bad, pos);
+    w->printable -= printable[w->data[pos]];
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+ulong EntropyMap(const CPU *cpu, const byte *data, ulong size, word address,
+                 entropy_t **map)
+{
+    window_t *w = AllocClear(sizeof *w);
+    ulong width = size < ENTROPY_WINDOW ? size : ENTROPY_WINDOW;
+    ulong alloc = 16;
+    ulong no = 0;
+    ulong pos;
+
+    if (!built)
+    {
+        Build();
+    }
+
+    *map = AllocClear(sizeof **map * alloc);
+    w->data = data;
+    w->start = AllocClear(size / 8 + 1);
+    w->bad = AllocClear(size / 8 + 1);
+
+    Sweep(w, cpu, size, address);
+
+    for(pos = 0; pos < size; pos += ENTROPY_BLOCK)
+    {
+        ulong block = size - pos < ENTROPY_BLOCK ? size - pos : ENTROPY_BLOCK;
+        ulong centre = pos + block / 2;
+        ulong lo = centre < width / 2 ? 0 : centre - width / 2;
+        entropy_t *e;
+        double entropy;
+        double illegal;
+        double text;
+        region_type_t type;
+
+        if (lo > size - width)
+        {
+            lo = size - width;
+        }
+
+        while(w->hi < lo + width)
+        {
+            Enter(w);
+        }
+
+        while(w->lo < lo)
+        {
+            Leave(w);
+        }
+
+        entropy = log2((double)width) - w->sum / (double)width;
+        illegal = w->starts ? (double)w->illegal / (double)w->starts : 0;
+        text = (double)w->printable / (double)width;
+
+        if (text >= TEXT_SHARE)
+        {
+            type = eRegionText;
+        }
+        else if (entropy >= HIGH_ENTROPY ||
+                 (entropy >= MIXED_ENTROPY && illegal >= HIGH_ILLEGAL))
+        {
+            type = eRegionSkip;
+        }
+        else
+        {
+            type = eRegionCode;
+        }
+
+        if (!no || (*map)[no - 1].type != type)
+        {
+            if (no == alloc)
+            {
+                alloc *= 2;
+                *map = Alloc(*map, sizeof **map * alloc);
+            }
+
+            e = *map + no++;
+            memset(e, 0, sizeof *e);
+            e->pos = pos;
+            e->type = type;
+        }
+
+        /* Weighted by size until the means are taken below
+        */
+        e = *map + no - 1;
+        e->size += block;
+        e->entropy += entropy * (double)block;
+        e->illegal += illegal * (double)block;
+        e->text += text * (double)block;
+    }
+
+    for(pos = 0; pos < no; pos++)
+    {
+        entropy_t *e = *map + pos;
+
+        e->entropy /= (double)e->size;
+        e->illegal /= (double)e->size;
+        e->text /= (double)e->size;
+    }
+
+    free(w->start);
+    free(w->bad);
+    free(w);
+
+    return no;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,65 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Entropy maps.
+
+*/
+
+#ifndef DASM_ENTROPY_H
+#define DASM_ENTROPY_H
+
+#include "global.h"
+#include "decode.h"
+#include "region.h"
+
+/* Bytes classified at a time, and the bytes around them they are
+   classified by
+*/
+#define ENTROPY_BLOCK   64
+#define ENTROPY_WINDOW  256
+
+/* A run of blocks of one class, as eRegionCode for code or anything else
+   of low entropy, eRegionText for text and eRegionSkip for compressed or
+   encrypted data.  The figures are the means over its blocks.
+*/
+typedef struct
+{
+    ulong               pos;
+    ulong               size;
+    region_type_t       type;
+    double              entropy;        /* Bits per byte */
+    double              illegal;        /* Share of illegal instructions */
+    double              text;           /* Share of printable bytes */
+} entropy_t;
+
+/* Classifies data, which is loaded at address, by the entropy, share of
+   illegal instructions and share of printable characters in a window
+   sliding over it.  Allocates the runs of each class in order to *map and
+   returns how many there are.
+*/
+ulong EntropyMap(const CPU *cpu, const byte *data, ulong size, word address,
+                 entropy_t **map);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
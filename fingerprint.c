@@ -0,0 +1,609 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Fingerprints of routines for finding code shared between images.
+
+    Windows are taken at every instruction of a linear sweep, and those
+    holding an illegal opcode or a single instruction repeated, such as a
+    run of fill bytes, are left out as they say nothing about the code.  A
+    loaded database is searched in place, as with sidecar indexes, so a
+    query costs a binary search per fingerprint of the routine.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+#include "fingerprint.h"
+#include "output.h"
+#include "util.h"
+
+#define VERSION         1
+#define HEADER_SIZE     28
+#define ENTRY_SIZE      12
+
+#define FNV_BASIS       0x811c9dc5ul
+#define FNV_PRIME       0x01000193ul
+
+/* The longest routine looked for when no count is given
+*/
+#define MAX_ROUTINE     0x400
+
+
+/* ---------------------------------------- TYPES
+*/
+
+/* A fingerprint of the routine being looked for
+*/
+typedef struct
+{
+    ulong       hash;
+    word        offset;         /* From the start of the routine */
+} probe_t;
+
+/* A place the routine may start, with the number of its fingerprints found
+   there
+*/
+typedef struct
+{
+    ulong       file;
+    word        start;
+    ulong       count;
+} match_t;
+
+typedef struct
+{
+    fingerprint_t       *db;
+    ulong               file;
+    probe_t             *probe;
+    ulong               no;
+    ulong               alloc;
+    word                start;
+} walk_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+static int Ends(const decode_t *d)
+{
+    switch(d->flow)
+    {
+        case eFlowJump:
+        case eFlowIndirect:
+        case eFlowHalt:
+            return TRUE;
+
+        case eFlowReturn:
+            return !d->conditional;
+
+        default:
+            return FALSE;
+    }
+}
+
+/* Hashes the window of instructions ending with number n, or returns FALSE
+   if it is to be left out.
+*/
+static int HashWindow(const ulong *token, const int *illegal, ulong n,
+                      ulong *hash)
+{
+    int same = TRUE;
+    int f;
+
+    *hash = FNV_BASIS;
+
+    for(f = 0; f < FINGERPRINT_WINDOW; f++)
+    {
+        int slot = (int)((n + (ulong)f) % FINGERPRINT_WINDOW);
+
+        if (illegal[slot])
+        {
+            return FALSE;
+        }
+
+        same = same && token[slot] == token[n % FINGERPRINT_WINDOW];
+
+        *hash = ((*hash ^ (token[slot] >> 8)) * FNV_PRIME) & 0xfffffffful;
+        *hash = ((*hash ^ (token[slot] & 0xff)) * FNV_PRIME) & 0xfffffffful;
+    }
+
+    return !same && *hash % FINGERPRINT_SAMPLE == 0;
+}
+
+/* Passes the kept fingerprints of the code at data to found with the
+   address of the first instruction of each.  If routine is set it stops
+   after count instructions or at the end of the routine.  Returns the
+   address after the last instruction.
+*/
+static word Walk(const CPU *cpu, const byte *data, ulong size, word address,
+                 int routine, ulong count,
+                 void (*found)(walk_t *w, ulong hash, word address),
+                 walk_t *w)
+{
+    ulong token[FINGERPRINT_WINDOW];
+    int illegal[FINGERPRINT_WINDOW];
+    word start[FINGERPRINT_WINDOW];
+    ulong pos = 0;
+    ulong n = 0;
+
+    while(pos < size)
+    {
+        decode_t d;
+        ulong len;
+        ulong hash;
+        int slot = (int)(n % FINGERPRINT_WINDOW);
+
+        if (!(len = (ulong)cpu->decode(data + pos, size - pos, address, &d)))
+        {
+            break;
+        }
+
+        token[slot] = (ulong)(d.page & 0xff) << 8 | (ulong)(d.opcode & 0xff);
+        illegal[slot] = d.illegal;
+        start[slot] = address;
+
+        pos += len;
+        address += (word)len;
+        n++;
+
+        if (n >= FINGERPRINT_WINDOW && HashWindow(token, illegal, n, &hash))
+        {
+            found(w, hash, start[n % FINGERPRINT_WINDOW]);
+        }
+
+        if (routine && (count ? n >= count : Ends(&d) || n >= MAX_ROUTINE))
+        {
+            break;
+        }
+    }
+
+    return address;
+}
+
+static void AddEntry(walk_t *w, ulong hash, word address)
+{
+    fingerprint_t *db = w->db;
+
+    if (db->no == db->alloc)
+    {
+        db->alloc = db->alloc ? db->alloc * 2 : 0x1000;
+        db->entry = Alloc(db->entry, sizeof *db->entry * db->alloc);
+    }
+
+    db->entry[db->no].hash = hash;
+    db->entry[db->no].file = w->file;
+    db->entry[db->no].address = address;
+    db->no++;
+}
+
+static void AddProbe(walk_t *w, ulong hash, word address)
+{
+    if (w->no == w->alloc)
+    {
+        w->alloc = w->alloc ? w->alloc * 2 : 64;
+        w->probe = Alloc(w->probe, sizeof *w->probe * w->alloc);
+    }
+
+    w->probe[w->no].hash = hash;
+    w->probe[w->no].offset = address - w->start;
+    w->no++;
+}
+
+static int CompareEntry(const void *a, const void *b)
+{
+    const fingerprint_entry_t *ea = a;
+    const fingerprint_entry_t *eb = b;
+
+    if (ea->hash != eb->hash)
+    {
+        return ea->hash < eb->hash ? -1 : 1;
+    }
+
+    if (ea->file != eb->file)
+    {
+        return ea->file < eb->file ? -1 : 1;
+    }
+
+    return ea->address < eb->address ? -1 :
+           ea->address > eb->address ? 1 : 0;
+}
+
+static int CompareStart(const void *a, const void *b)
+{
+    const match_t *ma = a;
+    const match_t *mb = b;
+
+    if (ma->file != mb->file)
+    {
+        return ma->file < mb->file ? -1 : 1;
+    }
+
+    return ma->start < mb->start ? -1 : ma->start > mb->start ? 1 : 0;
+}
+
+static int CompareCount(const void *a, const void *b)
+{
+    const match_t *ma = a;
+    const match_t *mb = b;
+
+    if (ma->count != mb->count)
+    {
+        return ma->count > mb->count ? -1 : 1;
+    }
+
+    return CompareStart(a, b);
+}
+
+static int FindFile(const fingerprint_t *db, const char *name)
+{
+    int f;
+
+    for(f = 0; f < db->files; f++)
+    {
+        if (strcmp(db->name[f], name) == 0)
+        {
+            return f;
+        }
+    }
+
+    return -1;
+}
+
+static void AddFile(fingerprint_t *db, const char *name)
+{
+    db->name = Alloc(db->name, sizeof *db->name * (size_t)(db->files + 1));
+    db->name[db->files++] = CopyString(name);
+}
+
+/* Returns the first entry of a loaded database at or after hash
+*/
+static ulong Find(const fingerprint_t *db, ulong hash)
+{
+    ulong lo = 0;
+    ulong hi = db->no;
+
+    while(lo < hi)
+    {
+        ulong mid = lo + (hi - lo) / 2;
+
+        if (Get32(db->table + mid * ENTRY_SIZE) < hash)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void FingerprintInit(fingerprint_t *db, const char *cpu)
+{
+    memset(db, 0, sizeof *db);
+    CopyName(db->cpu, sizeof db->cpu, cpu);
+}
+
+int FingerprintIsDatabase(const byte *data, ulong size)
+{
+    return size >= HEADER_SIZE && memcmp(data, "DFPR", 4) == 0;
+}
+
+int FingerprintLoad(fingerprint_t *db, const char *path)
+{
+    const byte *p;
+    const byte *name;
+    ulong end;
+    ulong pos;
+    int f;
+
+    memset(db, 0, sizeof *db);
+
+    if (!ImageOpen(&db->file, path))
+    {
+        fprintf(stderr, "dasm: cannot read fingerprints %s\n", path);
+        return FALSE;
+    }
+
+    p = db->file.file;
+    end = db->file.file_size;
+
+    if (!FingerprintIsDatabase(p, end) || Get32(p + 4) != VERSION ||
+        Get32(p + 16) != FINGERPRINT_WINDOW)
+    {
+        fprintf(stderr, "dasm: %s is not a fingerprint database\n", path);
+        ImageClose(&db->file);
+        return FALSE;
+    }
+
+    memcpy(db->cpu, p + 8, FINGERPRINT_CPU);
+    db->files = (int)Get32(p + 20);
+    db->no = Get32(p + 24);
+    db->table = p + HEADER_SIZE;
+    db->loaded = TRUE;
+
+    if (db->no > (end - HEADER_SIZE) / ENTRY_SIZE || db->files < 0)
+    {
+        fprintf(stderr, "dasm: fingerprints %s are damaged\n", path);
+        FingerprintFree(db);
+        return FALSE;
+    }
+
+    /* The names are pointed to where they lie in the file
+    */
+    pos = HEADER_SIZE + db->no * ENTRY_SIZE;
+    db->name = Alloc(NULL, sizeof *db->name * (size_t)db->files);
+
+    for(f = 0; f < db->files; f++)
+    {
+        name = p + pos;
+
+        while(pos < end && p[pos])
+        {
+            pos++;
+        }
+
+        if (pos++ == end)
+        {
+            fprintf(stderr, "dasm: fingerprints %s are damaged\n", path);
+            db->files = f;
+            FingerprintFree(db);
+            return FALSE;
+        }
+
+        db->name[f] = (char *)name;
+    }
+
+    return TRUE;
+}
+
+int FingerprintMerge(fingerprint_t *db, const fingerprint_t *other)
+{
+    ulong *file;
+    ulong n;
+    int f;
+
+    if (strcmp(db->cpu, other->cpu))
+    {
+        fprintf(stderr, "dasm: cannot merge %s fingerprints with %s\n",
+                other->cpu, db->cpu);
+        return FALSE;
+    }
+
+    /* Number the files of other as they are in db, or past the end if
+       they are already there
+    */
+    file = Alloc(NULL, sizeof *file * (size_t)other->files);
+
+    for(f = 0; f < other->files; f++)
+    {
+        if (FindFile(db, other->name[f]) != -1)
+        {
+            file[f] = ULONG_MAX;
+        }
+        else
+        {
+            file[f] = (ulong)db->files;
+            AddFile(db, other->name[f]);
+        }
+    }
+
+    for(n = 0; n < other->no; n++)
+    {
+        const byte *e = other->table + n * ENTRY_SIZE;
+        ulong no = Get32(e + 4);
+        walk_t w;
+
+        if (no < (ulong)other->files && file[no] != ULONG_MAX)
+        {
+            w.db = db;
+            w.file = file[no];
+            AddEntry(&w, Get32(e), (word)Get32(e + 8));
+        }
+    }
+
+    free(file);
+
+    return TRUE;
+}
+
+int FingerprintAdd(fingerprint_t *db, const CPU *cpu, const image_t *img,
+                   const char *name)
+{
+    walk_t w;
+    int n;
+
+    if (FindFile(db, name) != -1)
+    {
+        return FALSE;
+    }
+
+    w.db = db;
+    w.file = (ulong)db->files;
+
+    AddFile(db, name);
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+
+        Walk(cpu, seg->data, seg->size, seg->address, FALSE, 0, AddEntry, &w);
+    }
+
+    return TRUE;
+}
+
+int FingerprintWrite(fingerprint_t *db, const char *path)
+{
+    FILE *fp;
+    char cpu[FINGERPRINT_CPU + 1];
+    ulong n;
+    int f;
+
+    qsort(db->entry, db->no, sizeof *db->entry, CompareEntry);
+
+    if (!(fp = fopen(path, "wb")))
+    {
+        return FALSE;
+    }
+
+    memset(cpu, 0, sizeof cpu);
+    CopyName(cpu, sizeof cpu, db->cpu);
+
+    fwrite("DFPR", 1, 4, fp);
+    Put32(fp, VERSION);
+    fwrite(cpu, 1, FINGERPRINT_CPU, fp);
+    Put32(fp, FINGERPRINT_WINDOW);
+    Put32(fp, (ulong)db->files);
+    Put32(fp, db->no);
+
+    for(n = 0; n < db->no; n++)
+    {
+        Put32(fp, db->entry[n].hash);
+        Put32(fp, db->entry[n].file);
+        Put32(fp, db->entry[n].address);
+    }
+
+    for(f = 0; f < db->files; f++)
+    {
+        fwrite(db->name[f], 1, strlen(db->name[f]) + 1, fp);
+    }
+
+    return fclose(fp) == 0;
+}
+
+void FingerprintFree(fingerprint_t *db)
+{
+    int f;
+
+    if (db->loaded)
+    {
+        ImageClose(&db->file);
+    }
+    else
+    {
+        for(f = 0; f < db->files; f++)
+        {
+            free(db->name[f]);
+        }
+    }
+
+    free(db->name);
+    free(db->entry);
+    memset(db, 0, sizeof *db);
+}
+
+int FingerprintQuery(const fingerprint_t *db, const CPU *cpu,
+                     const byte *data, ulong size, word address,
+                     ulong count)
+{
+    match_t *match = NULL;
+    ulong no = 0;
+    ulong alloc = 0;
+    ulong n;
+    ulong k;
+    walk_t w;
+    word end;
+
+    memset(&w, 0, sizeof w);
+    w.start = address;
+
+    end = Walk(cpu, data, size, address, TRUE, count, AddProbe, &w);
+
+    if (w.no == 0)
+    {
+        return FALSE;
+    }
+
+    OutputComment("routine $%4.4x-$%4.4x, %u fingerprints", address, end - 1,
+                  (unsigned)w.no);
+
+    /* Every hit suggests where a copy of the routine would start
+    */
+    for(n = 0; n < w.no; n++)
+    {
+        ulong e;
+
+        for(e = Find(db, w.probe[n].hash);
+            e < db->no && Get32(db->table + e * ENTRY_SIZE) == w.probe[n].hash;
+            e++)
+        {
+            const byte *p = db->table + e * ENTRY_SIZE;
+
+            if (no == alloc)
+            {
+                alloc = alloc ? alloc * 2 : 256;
+                match = Alloc(match, sizeof *match * alloc);
+            }
+
+            match[no].file = Get32(p + 4);
+            match[no].start = (word)Get32(p + 8) - w.probe[n].offset;
+            match[no].count = 1;
+            no++;
+        }
+    }
+
+    /* Count the hits on each start
+    */
+    qsort(match, no, sizeof *match, CompareStart);
+
+    for(n = 0, k = 0; n < no; n++)
+    {
+        if (k > 0 && CompareStart(match + k - 1, match + n) == 0)
+        {
+            match[k - 1].count++;
+        }
+        else
+        {
+            match[k++] = match[n];
+        }
+    }
+
+    no = k;
+
+    qsort(match, no, sizeof *match, CompareCount);
+
+    for(n = 0; n < no && n < FINGERPRINT_RESULTS; n++)
+    {
+        ulong pct = match[n].count * 100 / w.no;
+
+        OutputComment("  %u%% %#s $%4.4x",
+                      (unsigned)(pct > 100 ? 100 : pct),
+                      match[n].file < (ulong)db->files ?
+                                        db->name[match[n].file] : "?",
+                      match[n].start);
+    }
+
+    free(match);
+    free(w.probe);
+
+    return TRUE;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,128 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Fingerprints of routines for finding code shared between images.
+
+    A fingerprint is a hash of a window of consecutive instructions, each
+    reduced to its opcode page and opcode so that the same code assembled at
+    another address, or working on other addresses, hashes the same.
+
+    A fingerprint database is little-endian and laid out as
+
+        "DFPR"
+        u32     version (1)
+        char    cpu[8]          NUL padded
+        u32     window          instructions hashed in each fingerprint
+        u32     files
+        u32     fingerprints
+
+    followed by the fingerprints, each a u32 hash, u32 file number and u32
+    address of the first instruction, sorted by hash, and then the names of
+    the files as NUL terminated strings.
+
+*/
+
+#ifndef DASM_FINGERPRINT_H
+#define DASM_FINGERPRINT_H
+
+#include "global.h"
+#include "decode.h"
+#include "image.h"
+
+#define FINGERPRINT_WINDOW      8
+#define FINGERPRINT_CPU         8
+
+/* Only one window in this many is kept, chosen by its hash so that the same
+   code keeps the same windows wherever it appears.
+*/
+#define FINGERPRINT_SAMPLE      4
+
+/* The most matches listed by FingerprintQuery()
+*/
+#define FINGERPRINT_RESULTS     20
+
+typedef struct
+{
+    ulong       hash;
+    ulong       file;
+    word        address;
+} fingerprint_entry_t;
+
+typedef struct
+{
+    char                cpu[FINGERPRINT_CPU + 1];
+    int                 files;
+    char                **name;
+    ulong               no;
+    ulong               alloc;
+    fingerprint_entry_t *entry;         /* Unless loaded */
+
+    /* Private
+    */
+    image_t             file;
+    const byte          *table;         /* Entries as stored in the file */
+    int                 loaded;
+} fingerprint_t;
+
+/* Starts an empty database
+*/
+void FingerprintInit(fingerprint_t *db, const char *cpu);
+
+/* Maps a database file for FingerprintQuery() or FingerprintMerge().
+   Returns FALSE after reporting an error.
+*/
+int FingerprintLoad(fingerprint_t *db, const char *path);
+
+/* Returns TRUE if data is the start of a database file
+*/
+int FingerprintIsDatabase(const byte *data, ulong size);
+
+/* Adds the files and fingerprints of a loaded database to one started with
+   FingerprintInit(), skipping files it already holds.  Returns FALSE after
+   reporting an error if they are for another CPU.
+*/
+int FingerprintMerge(fingerprint_t *db, const fingerprint_t *other);
+
+/* Adds the fingerprints of every segment of img under name.  Returns FALSE
+   if name is already in the database.
+*/
+int FingerprintAdd(fingerprint_t *db, const CPU *cpu, const image_t *img,
+                   const char *name);
+
+int FingerprintWrite(fingerprint_t *db, const char *path);
+
+void FingerprintFree(fingerprint_t *db);
+
+/* Lists as comments the places in a loaded database most like the routine
+   at address, by the share of its fingerprints they hold.  The routine runs
+   for count instructions or, if count is 0, up to the first instruction
+   that does not fall through or branch.  Returns FALSE if the routine is
+   too short to have any fingerprints.
+*/
+int FingerprintQuery(const fingerprint_t *db, const CPU *cpu,
+                     const byte *data, ulong size, word address,
+                     ulong count);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
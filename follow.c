@@ -0,0 +1,166 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Follow mode for growing files.
+
+    New bytes are read onto the end of whatever is left over from the last
+    read.  Only complete instructions, as measured by the CPU's decoder, are
+    disassembled, so a partial instruction at the end of the file is held
+    back until the rest of it arrives.  On Linux inotify is used to wait for
+    the file to change, elsewhere it is polled.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_SLEEP
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define USE_INOTIFY
+#include <sys/inotify.h>
+#endif
+
+#include "follow.h"
+#include "memory.h"
+
+#define CHUNK           0x10000
+#define POLL_SECONDS    1
+
+
+/* Waits for a file to change
+*/
+static void Wait(int watch)
+{
+#ifdef USE_INOTIFY
+    if (watch != -1)
+    {
+        char event[4096];
+
+        if (read(watch, event, sizeof event) > 0)
+        {
+            return;
+        }
+    }
+#endif
+
+#ifdef USE_SLEEP
+    sleep(POLL_SECONDS);
+#endif
+}
+
+ulong FollowDecode(const CPU *cpu, const byte *buff, ulong size,
+                   word *address, word (*step)(input_t *input, word address))
+{
+    ulong pos = 0;
+
+    while(pos < size)
+    {
+        decode_t d;
+        input_t input;
+        ulong len;
+        word next;
+
+        len = (ulong)cpu->decode(buff + pos, size - pos, *address, &d);
+
+        if (len == 0)
+        {
+            /* A run of prefixes longer than any instruction can't be
+               waited on forever, so let the disassembler deal with it.
+            */
+            if (size - pos <= MAX_MEMORY_BUFFER)
+            {
+                break;
+            }
+
+            len = size - pos;
+        }
+
+        InputInit(&input, buff + pos, len);
+        next = step(&input, *address);
+
+        if (next == *address)
+        {
+            break;
+        }
+
+        pos += next - *address;
+        *address = next;
+    }
+
+    return pos;
+}
+
+int Follow(const CPU *cpu, const char *path, word origin,
+           word (*step)(input_t *input, word address))
+{
+    static byte buff[MAX_MEMORY_BUFFER + CHUNK];
+    FILE *fp;
+    ulong held = 0;
+    word address = origin;
+    int watch = -1;
+
+    if (!(fp = fopen(path, "rb")))
+    {
+        return FALSE;
+    }
+
+#ifdef USE_INOTIFY
+    if ((watch = inotify_init()) != -1)
+    {
+        if (inotify_add_watch(watch, path, IN_MODIFY | IN_CLOSE_WRITE) == -1)
+        {
+            close(watch);
+            watch = -1;
+        }
+    }
+#endif
+
+    for(;;)
+    {
+        size_t n;
+        ulong used;
+
+        n = fread(buff + held, 1, sizeof buff - held, fp);
+
+        if (n == 0)
+        {
+            fflush(stdout);
+            clearerr(fp);
+            Wait(watch);
+            continue;
+        }
+
+        held += n;
+        used = FollowDecode(cpu, buff, held, &address, step);
+
+        held -= used;
+        memmove(buff, buff + used, held);
+    }
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,50 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Follow mode for growing files.
+
+*/
+
+#ifndef DASM_FOLLOW_H
+#define DASM_FOLLOW_H
+
+#include "global.h"
+#include "decode.h"
+
+/* Disassembles a file from origin with step and then keeps disassembling
+   bytes as they are appended to it, in the manner of tail -f.  Only returns
+   if the file cannot be read.
+*/
+int Follow(const CPU *cpu, const char *path, word origin,
+           word (*step)(input_t *input, word address));
+
+/* Disassembles the complete instructions in buff, which starts at *address,
+   with step, returning how many bytes were used and moving *address on.
+   An instruction cut off by the end of buff is left for the next call.
+*/
+ulong FollowDecode(const CPU *cpu, const byte *buff, ulong size,
+                   word *address, word (*step)(input_t *input, word address));
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,448 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Intel HEX and Motorola S-record loaders.
+
+    The file is parsed in a single pass.  Record data is appended to a
+    pool, extending the current run while records follow on from each
+    other.  At the end the runs are sorted by address and joined where they
+    touch, so memory use follows the amount of data rather than the span of
+    addresses it covers.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hexfile.h"
+#include "util.h"
+
+/* Longest record: count, 4 address bytes, 255 data bytes and checksum
+*/
+#define MAX_RECORD      261
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    word        address;
+    ulong       offset;         /* Offset of the data in the pool */
+    ulong       size;
+    ulong       order;          /* Position in the file */
+} run_t;
+
+typedef struct
+{
+    image_t     *img;
+    const char  *format;
+    ulong       line;
+
+    byte        *pool;
+    ulong       pool_size;
+    ulong       pool_alloc;
+
+    run_t       *run;
+    ulong       no;
+    ulong       alloc;
+} builder_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+static int Error(builder_t *b, const char *msg)
+{
+    fprintf(stderr, "dasm: bad %s file: line %lu: %s\n",
+                    b->format, b->line, msg);
+
+    free(b->pool);
+    free(b->run);
+
+    return FALSE;
+}
+
+/* Skips to the start of the next record, counting lines.  Returns FALSE at
+   the end of the file.
+*/
+static int NextRecord(builder_t *b, const byte **p, const byte *end)
+{
+    while(*p < end && (**p == '\n' || **p == '\r' || **p == ' ' ||
+                       **p == '\t' || **p == 0x1a))
+    {
+        if (**p == '\n')
+        {
+            b->line++;
+        }
+
+        (*p)++;
+    }
+
+    return *p < end;
+}
+
+/* Reads hex pairs up to the end of the line into rec, returning the number
+   of bytes or -1 if the line holds anything else.
+*/
+static int ReadRecord(const byte **p, const byte *end, byte *rec)
+{
+    const byte *s = *p;
+    int no = 0;
+
+    while(s + 1 < end && hex_value[s[0]] >= 0 && hex_value[s[1]] >= 0)
+    {
+        if (no == MAX_RECORD)
+        {
+            return -1;
+        }
+
+        rec[no++] = (byte)(hex_value[s[0]] << 4 | hex_value[s[1]]);
+        s += 2;
+    }
+
+    *p = s;
+
+    if (s < end && *s != '\n' && *s != '\r' && *s != ' ' && *s != '\t')
+    {
+        return -1;
+    }
+
+    return no;
+}
+
+static void AddData(builder_t *b, word address, const byte *data, ulong len)
+{
+    run_t *r = b->no ? b->run + b->no - 1 : NULL;
+
+    if (len == 0)
+    {
+        return;
+    }
+
+    if (!r || r->address + r->size != address)
+    {
+        if (b->no == b->alloc)
+        {
+            b->alloc = b->alloc ? b->alloc * 2 : 64;
+            b->run = Alloc(b->run, sizeof *b->run * b->alloc);
+        }
+
+        r = b->run + b->no;
+        r->address = address;
+        r->offset = b->pool_size;
+        r->size = 0;
+        r->order = b->no++;
+    }
+
+    if (b->pool_size + len > b->pool_alloc)
+    {
+        b->pool_alloc = b->pool_alloc ? b->pool_alloc * 2 : 0x10000;
+        b->pool = Alloc(b->pool, b->pool_alloc);
+    }
+
+    memcpy(b->pool + b->pool_size, data, len);
+    b->pool_size += len;
+    r->size += len;
+}
+
+static int CompareRun(const void *a, const void *b)
+{
+    const run_t *ra = a;
+    const run_t *rb = b;
+
+    if (ra->address != rb->address)
+    {
+        return ra->address < rb->address ? -1 : 1;
+    }
+
+    return ra->order < rb->order ? -1 : 1;
+}
+
+/* Sorts the runs and joins those that touch or overlap into segments.  Where
+   runs start at the same address the later one in the file wins.
+*/
+static void Finish(builder_t *b)
+{
+    byte *out;
+    ulong f;
+    ulong used = 0;
+    ulong seg_start = 0;
+    word address = 0;
+    word end = 0;
+
+    qsort(b->run, b->no, sizeof *b->run, CompareRun);
+
+    out = ImageAlloc(b->img, b->pool_size);
+
+    for(f = 0; f < b->no; f++)
+    {
+        const run_t *r = b->run + f;
+
+        if (f > 0 && r->address <= end)
+        {
+            ulong at = seg_start + (r->address - address);
+
+            memcpy(out + at, b->pool + r->offset, r->size);
+
+            if (r->address + r->size > end)
+            {
+                end = r->address + r->size;
+                used = seg_start + (end - address);
+            }
+        }
+        else
+        {
+            if (f > 0)
+            {
+                ImageAddSegment(b->img, address, out + seg_start,
+                                used - seg_start, NO_BANK);
+            }
+
+            seg_start = used;
+            address = r->address;
+            end = r->address + r->size;
+
+            memcpy(out + used, b->pool + r->offset, r->size);
+            used += r->size;
+        }
+    }
+
+    if (b->no)
+    {
+        ImageAddSegment(b->img, address, out + seg_start,
+                        used - seg_start, NO_BANK);
+    }
+
+    free(b->pool);
+    free(b->run);
+}
+
+static void InitBuilder(builder_t *b, image_t *img)
+{
+    memset(b, 0, sizeof *b);
+
+    b->img = img;
+    b->format = img->format;
+    b->line = 1;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int LoadIntelHex(image_t *img, word origin)
+{
+    const byte *p = img->file;
+    const byte *end = p + img->file_size;
+    builder_t b;
+    byte rec[MAX_RECORD];
+    word base = 0;
+
+    (void)origin;
+
+    InitBuilder(&b, img);
+
+    while(NextRecord(&b, &p, end))
+    {
+        int no;
+        int len;
+        int sum = 0;
+        int f;
+
+        if (*p++ != ':')
+        {
+            return Error(&b, "record does not start with ':'");
+        }
+
+        no = ReadRecord(&p, end, rec);
+
+        if (no < 5 || no != rec[0] + 5)
+        {
+            return Error(&b, "bad record length");
+        }
+
+        for(f = 0; f < no; f++)
+        {
+            sum += rec[f];
+        }
+
+        if (sum & 0xff)
+        {
+            return Error(&b, "checksum error");
+        }
+
+        len = rec[0];
+
+        switch(rec[3])
+        {
+            case 0x00:
+                AddData(&b, base + (rec[1] << 8 | rec[2]), rec + 4,
+                        (ulong)len);
+                break;
+
+            case 0x01:
+                Finish(&b);
+                return TRUE;
+
+            case 0x02:
+                if (len != 2)
+                {
+                    return Error(&b, "bad length for record type");
+                }
+
+                base = (word)(rec[4] << 8 | rec[5]) << 4;
+                break;
+
+            case 0x03:
+                if (len != 4)
+                {
+                    return Error(&b, "bad length for record type");
+                }
+
+                img->has_entry = TRUE;
+                img->entry = ((word)(rec[4] << 8 | rec[5]) << 4) +
+                                    (rec[6] << 8 | rec[7]);
+                break;
+
+            case 0x04:
+                if (len != 2)
+                {
+                    return Error(&b, "bad length for record type");
+                }
+
+                base = (word)(rec[4] << 8 | rec[5]) << 16;
+                break;
+
+            case 0x05:
+                if (len != 4)
+                {
+                    return Error(&b, "bad length for record type");
+                }
+
+                img->has_entry = TRUE;
+                img->entry = (word)rec[4] << 24 | (word)rec[5] << 16 |
+                                    (word)rec[6] << 8 | rec[7];
+                break;
+
+            default:
+                return Error(&b, "unknown record type");
+        }
+    }
+
+    Finish(&b);
+
+    return TRUE;
+}
+
+int LoadSRecord(image_t *img, word origin)
+{
+    const byte *p = img->file;
+    const byte *end = p + img->file_size;
+    builder_t b;
+    byte rec[MAX_RECORD];
+
+    (void)origin;
+
+    InitBuilder(&b, img);
+
+    while(NextRecord(&b, &p, end))
+    {
+        word address = 0;
+        int type;
+        int alen;
+        int no;
+        int sum = 0;
+        int f;
+
+        if (p + 2 > end || p[0] != 'S' || p[1] < '0' || p[1] > '9')
+        {
+            return Error(&b, "record does not start with S0-S9");
+        }
+
+        type = p[1] - '0';
+        p += 2;
+
+        no = ReadRecord(&p, end, rec);
+
+        if (no < 3 || no != rec[0] + 1)
+        {
+            return Error(&b, "bad record length");
+        }
+
+        for(f = 0; f < no; f++)
+        {
+            sum += rec[f];
+        }
+
+        if ((sum & 0xff) != 0xff)
+        {
+            return Error(&b, "checksum error");
+        }
+
+        switch(type)
+        {
+            case 1:
+            case 9:
+                alen = 2;
+                break;
+
+            case 2:
+            case 8:
+                alen = 3;
+                break;
+
+            case 3:
+            case 7:
+                alen = 4;
+                break;
+
+            default:
+                continue;
+        }
+
+        if (no < alen + 2)
+        {
+            return Error(&b, "record too short for address");
+        }
+
+        for(f = 0; f < alen; f++)
+        {
+            address = address << 8 | rec[1 + f];
+        }
+
+        if (type <= 3)
+        {
+            AddData(&b, address, rec + 1 + alen, (ulong)(no - alen - 2));
+        }
+        else
+        {
+            img->has_entry = TRUE;
+            img->entry = address;
+        }
+    }
+
+    Finish(&b);
+
+    return TRUE;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,42 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Intel HEX and Motorola S-record loaders.
+
+*/
+
+#ifndef DASM_HEXFILE_H
+#define DASM_HEXFILE_H
+
+#include "global.h"
+#include "image.h"
+
+/* Parse the mapped file of an image into a sorted list of segments, one for
+   each populated run of addresses.  Return FALSE after reporting an error.
+*/
+int LoadIntelHex(image_t *img, word origin);
+int LoadSRecord(image_t *img, word origin);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,183 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Images to disassemble.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define USE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "image.h"
+#include "util.h"
+
+#ifdef USE_MMAP
+static int Map(image_t *img, const char *path)
+{
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) == -1)
+    {
+        return FALSE;
+    }
+
+    if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) || st.st_size == 0)
+    {
+        close(fd);
+        return FALSE;
+    }
+
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (p == MAP_FAILED)
+    {
+        return FALSE;
+    }
+
+    img->file = p;
+    img->file_size = (ulong)st.st_size;
+    img->mapped = TRUE;
+
+    return TRUE;
+}
+#endif
+
+static int Read(image_t *img, const char *path)
+{
+    FILE *fp;
+    byte *buff = NULL;
+    ulong size = 0;
+    ulong alloc = 0;
+    size_t n;
+
+    if (!(fp = fopen(path, "rb")))
+    {
+        return FALSE;
+    }
+
+    do
+    {
+        if (size == alloc)
+        {
+            alloc = alloc ? alloc * 2 : 0x10000;
+            buff = Alloc(buff, alloc);
+        }
+
+        n = fread(buff + size, 1, alloc - size, fp);
+        size += n;
+    } while(n > 0);
+
+    fclose(fp);
+
+    img->file = buff;
+    img->file_size = size;
+    img->mapped = FALSE;
+
+    return TRUE;
+}
+
+int ImageOpen(image_t *img, const char *path)
+{
+    memset(img, 0, sizeof *img);
+
+    img->format = "binary";
+
+#ifdef USE_MMAP
+    if (Map(img, path))
+    {
+        return TRUE;
+    }
+#endif
+
+    return Read(img, path);
+}
+
+void ImageClose(image_t *img)
+{
+    int f;
+
+#ifdef USE_MMAP
+    if (img->mapped)
+    {
+        munmap((void *)img->file, img->file_size);
+    }
+    else
+#endif
+    {
+        free((void *)img->file);
+    }
+
+    for(f = 0; f < img->no_buffers; f++)
+    {
+        free(img->buffer[f]);
+    }
+
+    free(img->buffer);
+    free(img->segment);
+
+    memset(img, 0, sizeof *img);
+}
+
+void ImageAddSegment(image_t *img, word address, const byte *data,
+                     ulong size, int bank)
+{
+    segment_t *s;
+
+    img->segment = Alloc(img->segment, sizeof *s * (img->no + 1));
+
+    s = img->segment + img->no++;
+
+    s->address = address;
+    s->data = data;
+    s->size = size;
+    s->bank = bank;
+}
+
+byte *ImageAlloc(image_t *img, ulong size)
+{
+    byte *p;
+
+    p = Alloc(NULL, size);
+    memset(p, 0, size);
+
+    img->buffer = Alloc(img->buffer, sizeof *img->buffer *
+                                        (img->no_buffers + 1));
+    img->buffer[img->no_buffers++] = p;
+
+    return p;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,86 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Images to disassemble.
+
+    An image is the file as mapped into memory plus a list of segments,
+    each a run of bytes to disassemble at a given address.  For a plain
+    binary there is a single segment covering the file.
+
+*/
+
+#ifndef DASM_IMAGE_H
+#define DASM_IMAGE_H
+
+#include "global.h"
+
+#define NO_BANK         -1
+
+typedef struct
+{
+    word        address;        /* Address of the first byte */
+    const byte  *data;
+    ulong       size;
+    int         bank;           /* Bank number or NO_BANK */
+} segment_t;
+
+typedef struct
+{
+    const byte  *file;          /* The file contents */
+    ulong       file_size;
+
+    const char  *format;        /* Name of the container format */
+    const char  *cpu;           /* CPU the format implies, or NULL */
+    int         has_entry;      /* TRUE if entry is set */
+    word        entry;          /* Entry point */
+
+    int         no;             /* Segments */
+    segment_t   *segment;
+
+    /* Private
+    */
+    int         mapped;
+    int         no_buffers;
+    byte        **buffer;
+} image_t;
+
+/* Maps a file into memory.  Returns FALSE and sets errno on failure.
+*/
+int ImageOpen(image_t *img, const char *path);
+
+/* Releases everything held by an image
+*/
+void ImageClose(image_t *img);
+
+/* Adds a segment to an image
+*/
+void ImageAddSegment(image_t *img, word address, const byte *data,
+                     ulong size, int bank);
+
+/* Allocates a buffer that is freed with the image
+*/
+byte *ImageAlloc(image_t *img, ulong size);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
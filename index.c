@@ -0,0 +1,341 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Sidecar indexes of instruction boundaries.
+
+    A loaded index is left mapped and its checkpoints are read straight out
+    of the file, so using one costs a binary search however large the image
+    it describes.  For the same reason the image is identified by hashing
+    its size and a fixed number of blocks spread through it rather than the
+    whole file.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "index.h"
+#include "util.h"
+
+#define VERSION         1
+#define HEADER_SIZE     40
+#define SEGMENT_SIZE    12
+
+#define FNV_BASIS       0x811c9dc5ul
+#define FNV_PRIME       0x01000193ul
+
+#define SAMPLE_BLOCK    0x1000
+#define SAMPLES         64
+
+
+/* ---------------------------------------- UTILS
+*/
+static ulong Hash(ulong hash, const byte *p, ulong size)
+{
+    while(size--)
+    {
+        hash = ((hash ^ *p++) * FNV_PRIME) & 0xfffffffful;
+    }
+
+    return hash;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+ulong IndexHash(const byte *data, ulong size)
+{
+    ulong hash = IndexHashValue(FNV_BASIS, size);
+    ulong n;
+
+    if (size <= SAMPLE_BLOCK * SAMPLES)
+    {
+        return Hash(hash, data, size);
+    }
+
+    for(n = 0; n < SAMPLES; n++)
+    {
+        ulong pos = (size - SAMPLE_BLOCK) / (SAMPLES - 1) * n;
+
+        if (n == SAMPLES - 1)
+        {
+            pos = size - SAMPLE_BLOCK;
+        }
+
+        hash = Hash(hash, data + pos, SAMPLE_BLOCK);
+    }
+
+    return hash;
+}
+
+ulong IndexHashValue(ulong hash, ulong n)
+{
+    byte b[4];
+
+    Set32(b, n);
+
+    return Hash(hash, b, sizeof b);
+}
+
+void IndexInit(index_t *idx, const char *cpu, word origin, ulong spacing,
+               const image_t *img, ulong options)
+{
+    int n;
+
+    memset(idx, 0, sizeof *idx);
+
+    CopyName(idx->cpu, sizeof idx->cpu, cpu);
+    idx->origin = origin;
+    idx->spacing = spacing ? spacing : INDEX_SPACING;
+    idx->file_size = img->file_size;
+    idx->hash = IndexHash(img->file, img->file_size);
+    idx->options = options;
+    idx->no = img->no;
+    idx->segment = Alloc(NULL, sizeof *idx->segment * (size_t)img->no);
+
+    for(n = 0; n < img->no; n++)
+    {
+        index_segment_t *s = idx->segment + n;
+
+        s->address = img->segment[n].address;
+        s->size = img->segment[n].size;
+        s->no = 0;
+        s->alloc = 0;
+        s->table = NULL;
+    }
+}
+
+int IndexLoad(index_t *idx, const char *path)
+{
+    const byte *p;
+    ulong pos;
+    ulong end;
+    int n;
+
+    memset(idx, 0, sizeof *idx);
+
+    if (!ImageOpen(&idx->file, path))
+    {
+        fprintf(stderr, "dasm: cannot read index %s\n", path);
+        return FALSE;
+    }
+
+    p = idx->file.file;
+    end = idx->file.file_size;
+
+    if (end < HEADER_SIZE || memcmp(p, "DIDX", 4) ||
+        Get32(p + 4) != VERSION)
+    {
+        fprintf(stderr, "dasm: %s is not an index\n", path);
+        ImageClose(&idx->file);
+        return FALSE;
+    }
+
+    memcpy(idx->cpu, p + 8, INDEX_CPU);
+    idx->origin = (word)Get32(p + 16);
+    idx->spacing = Get32(p + 20);
+    idx->file_size = Get32(p + 24);
+    idx->hash = Get32(p + 28);
+    idx->options = Get32(p + 32);
+    idx->no = (int)Get32(p + 36);
+    idx->loaded = TRUE;
+
+    pos = HEADER_SIZE + (ulong)idx->no * SEGMENT_SIZE;
+
+    if (idx->spacing == 0 || idx->no < 0 || pos > end)
+    {
+        fprintf(stderr, "dasm: index %s is damaged\n", path);
+        IndexFree(idx);
+        return FALSE;
+    }
+
+    idx->segment = Alloc(NULL, sizeof *idx->segment * (size_t)idx->no);
+
+    for(n = 0; n < idx->no; n++)
+    {
+        const byte *s = p + HEADER_SIZE + n * SEGMENT_SIZE;
+        index_segment_t *seg = idx->segment + n;
+
+        seg->address = (word)Get32(s);
+        seg->size = Get32(s + 4);
+        seg->no = Get32(s + 8);
+        seg->alloc = 0;
+        seg->table = (byte *)p + pos;
+
+        if (seg->no > (end - pos) / 4)
+        {
+            fprintf(stderr, "dasm: index %s is damaged\n", path);
+            IndexFree(idx);
+            return FALSE;
+        }
+
+        pos += seg->no * 4;
+    }
+
+    return TRUE;
+}
+
+int IndexMatches(const index_t *idx, const index_t *template)
+{
+    int n;
+
+    if (strcmp(idx->cpu, template->cpu) ||
+        idx->origin != template->origin ||
+        idx->file_size != template->file_size ||
+        idx->hash != template->hash ||
+        idx->options != template->options ||
+        idx->no != template->no)
+    {
+        return FALSE;
+    }
+
+    for(n = 0; n < idx->no; n++)
+    {
+        if (idx->segment[n].address != template->segment[n].address ||
+            idx->segment[n].size != template->segment[n].size)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+int IndexWrite(const index_t *idx, const char *path)
+{
+    FILE *fp;
+    char cpu[INDEX_CPU + 1];
+    int n;
+
+    if (!(fp = fopen(path, "wb")))
+    {
+        return FALSE;
+    }
+
+    memset(cpu, 0, sizeof cpu);
+    CopyName(cpu, sizeof cpu, idx->cpu);
+
+    fwrite("DIDX", 1, 4, fp);
+    Put32(fp, VERSION);
+    fwrite(cpu, 1, INDEX_CPU, fp);
+    Put32(fp, idx->origin);
+    Put32(fp, idx->spacing);
+    Put32(fp, idx->file_size);
+    Put32(fp, idx->hash);
+    Put32(fp, idx->options);
+    Put32(fp, (ulong)idx->no);
+
+    for(n = 0; n < idx->no; n++)
+    {
+        Put32(fp, idx->segment[n].address);
+        Put32(fp, idx->segment[n].size);
+        Put32(fp, idx->segment[n].no);
+    }
+
+    for(n = 0; n < idx->no; n++)
+    {
+        fwrite(idx->segment[n].table, 4, idx->segment[n].no, fp);
+    }
+
+    return fclose(fp) == 0;
+}
+
+void IndexFree(index_t *idx)
+{
+    int n;
+
+    if (idx->loaded)
+    {
+        ImageClose(&idx->file);
+    }
+    else
+    {
+        for(n = 0; n < idx->no; n++)
+        {
+            free(idx->segment[n].table);
+        }
+    }
+
+    free(idx->segment);
+    memset(idx, 0, sizeof *idx);
+}
+
+void IndexAdd(index_t *idx, int seg, ulong pos)
+{
+    index_segment_t *s = idx->segment + seg;
+
+    while(s->no * idx->spacing <= pos)
+    {
+        if (s->no == s->alloc)
+        {
+            s->alloc = s->alloc ? s->alloc * 2 : 1024;
+            s->table = Alloc(s->table, s->alloc * 4);
+        }
+
+        Set32(s->table + s->no * 4, pos);
+        s->no++;
+    }
+}
+
+ulong IndexFind(const index_t *idx, int seg, ulong pos)
+{
+    const index_segment_t *s;
+    ulong lo = 0;
+    ulong hi;
+
+    if (seg >= idx->no)
+    {
+        return 0;
+    }
+
+    s = idx->segment + seg;
+
+    /* The checkpoint nearest pos is usually the answer, unless a long line
+       covers it.
+    */
+    hi = pos / idx->spacing + 1;
+
+    if (hi > s->no)
+    {
+        hi = s->no;
+    }
+
+    while(lo < hi)
+    {
+        ulong mid = lo + (hi - lo) / 2;
+
+        if (Get32(s->table + mid * 4) <= pos)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo ? Get32(s->table + (lo - 1) * 4) : 0;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
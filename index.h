@@ -0,0 +1,119 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Sidecar indexes of instruction boundaries.
+
+    An index file is little-endian and laid out as
+
+        "DIDX"
+        u32     version (1)
+        char    cpu[8]          NUL padded
+        u32     origin
+        u32     spacing         bytes between checkpoints
+        u32     file size
+        u32     file hash
+        u32     options hash    of the regions the listing was made with
+        u32     segments
+
+    followed by the address, size and number of checkpoints of each segment
+    as three u32s, and then the checkpoints of every segment in turn, each a
+    u32 offset into the segment.  Checkpoint n is the first line of the
+    listing to start at or after n * spacing.
+
+*/
+
+#ifndef DASM_INDEX_H
+#define DASM_INDEX_H
+
+#include "global.h"
+#include "image.h"
+
+#define INDEX_SPACING   0x400
+#define INDEX_CPU       8
+
+typedef struct
+{
+    word        address;
+    ulong       size;
+    ulong       no;             /* Checkpoints */
+    ulong       alloc;
+    byte        *table;         /* Checkpoints as stored in the file */
+} index_segment_t;
+
+typedef struct
+{
+    char                cpu[INDEX_CPU + 1];
+    word                origin;
+    ulong               spacing;
+    ulong               file_size;
+    ulong               hash;
+    ulong               options;
+    int                 no;
+    index_segment_t     *segment;
+
+    /* Private
+    */
+    image_t             file;
+    int                 loaded;
+} index_t;
+
+/* Starts an empty index of the segments of img
+*/
+void IndexInit(index_t *idx, const char *cpu, word origin, ulong spacing,
+               const image_t *img, ulong options);
+
+/* Reads an index file.  Returns FALSE after reporting an error.
+*/
+int IndexLoad(index_t *idx, const char *path);
+
+/* Returns TRUE if idx was made from the same image with the same settings
+   as template, which is made by IndexInit.
+*/
+int IndexMatches(const index_t *idx, const index_t *template);
+
+int IndexWrite(const index_t *idx, const char *path);
+
+void IndexFree(index_t *idx);
+
+/* Records that a line starts at pos in segment seg.  Lines must be added
+   in order.
+*/
+void IndexAdd(index_t *idx, int seg, ulong pos);
+
+/* Returns the offset of the last checkpoint in segment seg at or before
+   pos, or 0 if there is none.
+*/
+ulong IndexFind(const index_t *idx, int seg, ulong pos);
+
+/* A hash of the size of a file and of blocks sampled through it, which
+   takes the same time for any size of file.
+*/
+ulong IndexHash(const byte *data, ulong size);
+
+/* Adds n to a hash started with IndexHash
+*/
+ulong IndexHashValue(ulong hash, ulong n);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,524 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Deflate decompression (RFC 1951).
+
+    Huffman codes are decoded canonically a bit at a time, as in Mark
+    Adler's puff.  Since the compressed data is all in memory a symbol can
+    always be decoded in one go, so the only places a read has to stop and
+    pick up again later are in the middle of a stored block or of a match,
+    both of which are just a count in the state.  Matches are copied out of
+    a 32K window of the most recent output, so memory use does not depend
+    on the size of the stream.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "inflate.h"
+
+#define MAX_BITS        15
+#define MAX_LENGTHS     286
+#define MAX_DISTANCES   30
+#define FIXED_LENGTHS   288
+
+#define WINDOW_MASK     (INFLATE_WINDOW - 1)
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef enum
+{
+    eHeader,
+    eStored,
+    eCodes,
+    eDone
+} state_t;
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static const short length_base[29] =
+{
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const short length_extra[29] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const short distance_base[30] =
+{
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577
+};
+
+static const short distance_extra[30] =
+{
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+/* Order the lengths of the code length code are sent in
+*/
+static const short code_order[19] =
+{
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+
+/* ---------------------------------------- UTILS
+*/
+static void Fail(inflate_t *z, const char *error)
+{
+    if (!z->error)
+    {
+        z->error = error;
+    }
+}
+
+static ulong Bits(inflate_t *z, int need)
+{
+    ulong value = z->bits;
+
+    while(z->no_bits < need)
+    {
+        if (z->in_pos == z->in_size)
+        {
+            Fail(z, "unexpected end of compressed data");
+            return 0;
+        }
+
+        value |= (ulong)z->in[z->in_pos++] << z->no_bits;
+        z->no_bits += 8;
+    }
+
+    z->bits = value >> need;
+    z->no_bits -= need;
+
+    return value & ((1ul << need) - 1);
+}
+
+/* Builds a canonical code from a list of code lengths.  Returns zero for a
+   complete code, more than zero for an incomplete one and less than zero
+   if it is over-subscribed.
+*/
+static int Construct(huffman_t *h, const short *length, int n)
+{
+    short offset[MAX_BITS + 1];
+    int symbol;
+    int len;
+    int left;
+
+    for(len = 0; len <= MAX_BITS; len++)
+    {
+        h->count[len] = 0;
+    }
+
+    for(symbol = 0; symbol < n; symbol++)
+    {
+        h->count[length[symbol]]++;
+    }
+
+    if (h->count[0] == n)
+    {
+        return 0;
+    }
+
+    left = 1;
+
+    for(len = 1; len <= MAX_BITS; len++)
+    {
+        left <<= 1;
+        left -= h->count[len];
+
+        if (left < 0)
+        {
+            return left;
+        }
+    }
+
+    offset[1] = 0;
+
+    for(len = 1; len < MAX_BITS; len++)
+    {
+        offset[len + 1] = (short)(offset[len] + h->count[len]);
+    }
+
+    for(symbol = 0; symbol < n; symbol++)
+    {
+        if (length[symbol])
+        {
+            h->symbol[offset[length[symbol]]++] = (short)symbol;
+        }
+    }
+
+    return left;
+}
+
+static int Decode(inflate_t *z, const huffman_t *h)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    int len;
+
+    for(len = 1; len <= MAX_BITS; len++)
+    {
+        int count;
+
+        code |= (int)Bits(z, 1);
+        count = h->count[len];
+
+        if (code - count < first)
+        {
+            return h->symbol[index + (code - first)];
+        }
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    Fail(z, "bad Huffman code");
+
+    return -1;
+}
+
+static void FixedCodes(inflate_t *z)
+{
+    short length[FIXED_LENGTHS];
+    int f;
+
+    for(f = 0; f < FIXED_LENGTHS; f++)
+    {
+        length[f] = f < 144 ? 8 : f < 256 ? 9 : f < 280 ? 7 : 8;
+    }
+
+    Construct(&z->length_code, length, FIXED_LENGTHS);
+
+    for(f = 0; f < MAX_DISTANCES; f++)
+    {
+        length[f] = 5;
+    }
+
+    Construct(&z->distance_code, length, MAX_DISTANCES);
+}
+
+static void DynamicCodes(inflate_t *z)
+{
+    short length[MAX_LENGTHS + MAX_DISTANCES];
+    int no_lengths;
+    int no_distances;
+    int no_codes;
+    int index;
+    int err;
+
+    no_lengths = (int)Bits(z, 5) + 257;
+    no_distances = (int)Bits(z, 5) + 1;
+    no_codes = (int)Bits(z, 4) + 4;
+
+    if (no_lengths > MAX_LENGTHS || no_distances > MAX_DISTANCES)
+    {
+        Fail(z, "bad code counts");
+        return;
+    }
+
+    for(index = 0; index < 19; index++)
+    {
+        length[code_order[index]] =
+                        index < no_codes ? (short)Bits(z, 3) : 0;
+    }
+
+    if (Construct(&z->length_code, length, 19) != 0)
+    {
+        Fail(z, "incomplete code length code");
+        return;
+    }
+
+    index = 0;
+
+    while(index < no_lengths + no_distances && !z->error)
+    {
+        int symbol = Decode(z, &z->length_code);
+        short len = 0;
+        int repeat;
+
+        if (symbol < 16)
+        {
+            length[index++] = (short)symbol;
+            continue;
+        }
+
+        if (symbol == 16)
+        {
+            if (index == 0)
+            {
+                Fail(z, "repeat with no previous length");
+                return;
+            }
+
+            len = length[index - 1];
+            repeat = 3 + (int)Bits(z, 2);
+        }
+        else if (symbol == 17)
+        {
+            repeat = 3 + (int)Bits(z, 3);
+        }
+        else
+        {
+            repeat = 11 + (int)Bits(z, 7);
+        }
+
+        if (index + repeat > no_lengths + no_distances)
+        {
+            Fail(z, "too many code lengths");
+            return;
+        }
+
+        while(repeat--)
+        {
+            length[index++] = len;
+        }
+    }
+
+    if (z->error)
+    {
+        return;
+    }
+
+    if (length[256] == 0)
+    {
+        Fail(z, "no end of block code");
+        return;
+    }
+
+    /* Incomplete codes are only allowed when there is a single code
+    */
+    err = Construct(&z->length_code, length, no_lengths);
+
+    if (err < 0 || (err > 0 && no_lengths - z->length_code.count[0] != 1))
+    {
+        Fail(z, "bad literal/length code");
+        return;
+    }
+
+    err = Construct(&z->distance_code, length + no_lengths, no_distances);
+
+    if (err < 0 ||
+        (err > 0 && no_distances - z->distance_code.count[0] != 1))
+    {
+        Fail(z, "bad distance code");
+    }
+}
+
+static void BlockHeader(inflate_t *z)
+{
+    if (z->last)
+    {
+        z->state = eDone;
+        return;
+    }
+
+    z->last = (int)Bits(z, 1);
+
+    switch(Bits(z, 2))
+    {
+        case 0:
+            /* Stored blocks start on a byte boundary
+            */
+            z->bits = 0;
+            z->no_bits = 0;
+
+            if (z->in_pos + 4 > z->in_size)
+            {
+                Fail(z, "unexpected end of compressed data");
+                return;
+            }
+
+            z->stored = z->in[z->in_pos] | (ulong)z->in[z->in_pos + 1] << 8;
+
+            if ((z->in[z->in_pos + 2] | (ulong)z->in[z->in_pos + 3] << 8) !=
+                (~z->stored & 0xffff))
+            {
+                Fail(z, "bad stored block length");
+                return;
+            }
+
+            z->in_pos += 4;
+            z->state = eStored;
+            break;
+
+        case 1:
+            FixedCodes(z);
+            z->state = eCodes;
+            break;
+
+        case 2:
+            DynamicCodes(z);
+            z->state = eCodes;
+            break;
+
+        default:
+            Fail(z, "bad block type");
+            break;
+    }
+}
+
+/* Decodes a symbol, returning a literal byte or -1 if it was anything else
+*/
+static int Symbol(inflate_t *z)
+{
+    int symbol = Decode(z, &z->length_code);
+    int len;
+
+    if (symbol < 256)
+    {
+        return symbol;
+    }
+
+    if (symbol == 256)
+    {
+        z->state = eHeader;
+        return -1;
+    }
+
+    symbol -= 257;
+
+    if (symbol >= 29)
+    {
+        Fail(z, "bad length code");
+        return -1;
+    }
+
+    len = length_base[symbol] + (int)Bits(z, length_extra[symbol]);
+
+    symbol = Decode(z, &z->distance_code);
+
+    if (symbol < 0 || symbol >= MAX_DISTANCES)
+    {
+        Fail(z, "bad distance code");
+        return -1;
+    }
+
+    z->distance = distance_base[symbol] + Bits(z, distance_extra[symbol]);
+
+    if (z->distance > z->total)
+    {
+        Fail(z, "distance too far back");
+        return -1;
+    }
+
+    z->copy = len;
+
+    return -1;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void InflateInit(inflate_t *z, const byte *in, ulong size)
+{
+    z->in = in;
+    z->in_size = size;
+    z->in_pos = 0;
+    z->bits = 0;
+    z->no_bits = 0;
+    z->state = eHeader;
+    z->last = FALSE;
+    z->stored = 0;
+    z->copy = 0;
+    z->distance = 0;
+    z->total = 0;
+    z->error = NULL;
+}
+
+ulong InflateRead(inflate_t *z, byte *out, ulong size)
+{
+    ulong n = 0;
+
+    while(n < size && !z->error)
+    {
+        int b = -1;
+
+        if (z->copy)
+        {
+            b = z->window[(z->total - z->distance) & WINDOW_MASK];
+            z->copy--;
+        }
+        else
+        {
+            switch(z->state)
+            {
+                case eHeader:
+                    BlockHeader(z);
+                    break;
+
+                case eStored:
+                    if (z->stored == 0)
+                    {
+                        z->state = eHeader;
+                    }
+                    else if (z->in_pos == z->in_size)
+                    {
+                        Fail(z, "unexpected end of compressed data");
+                    }
+                    else
+                    {
+                        b = z->in[z->in_pos++];
+                        z->stored--;
+                    }
+                    break;
+
+                case eCodes:
+                    b = Symbol(z);
+                    break;
+
+                default:
+                    return n;
+            }
+        }
+
+        if (b >= 0 && !z->error)
+        {
+            out[n++] = (byte)b;
+            z->window[z->total++ & WINDOW_MASK] = (byte)b;
+        }
+    }
+
+    return n;
+}
+
+int InflateDone(const inflate_t *z)
+{
+    return z->state == eDone;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
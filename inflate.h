@@ -0,0 +1,85 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Deflate decompression.
+
+*/
+
+#ifndef DASM_INFLATE_H
+#define DASM_INFLATE_H
+
+#include "global.h"
+
+#define INFLATE_WINDOW  0x8000
+#define INFLATE_CODES   288
+
+/* A canonical Huffman code
+*/
+typedef struct
+{
+    short       count[16];      /* Number of codes of each length */
+    short       symbol[INFLATE_CODES];
+} huffman_t;
+
+/* The state of a raw deflate stream.  The compressed data must all be in
+   memory, but the output can be taken in pieces of any size.
+*/
+typedef struct
+{
+    const byte  *in;
+    ulong       in_size;
+    ulong       in_pos;
+
+    ulong       bits;
+    int         no_bits;
+
+    int         state;
+    int         last;           /* Current block is the last */
+    ulong       stored;         /* Bytes left in a stored block */
+    int         copy;           /* Bytes left to copy from a match */
+    ulong       distance;
+
+    huffman_t   length_code;
+    huffman_t   distance_code;
+
+    ulong       total;          /* Bytes output */
+    byte        window[INFLATE_WINDOW];
+
+    const char  *error;         /* Set if the stream is damaged */
+} inflate_t;
+
+void InflateInit(inflate_t *z, const byte *in, ulong size);
+
+/* Decompresses up to size bytes into out, returning the number written.
+   Returns less than size only at the end of the stream or on an error, in
+   which case error is set.
+*/
+ulong InflateRead(inflate_t *z, byte *out, ulong size);
+
+/* TRUE once the end of the last block has been read
+*/
+int InflateDone(const inflate_t *z);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
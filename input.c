@@ -24,52 +24,74 @@
 */
 #include "input.h"
 
-byte GetByte(FILE *fp, word *address, memory_t *memory)
+void InputInit(input_t *in, const byte *data, ulong size)
+{
+    in->data = data;
+    in->size = size;
+    in->pos = 0;
+    in->eof = FALSE;
+}
+
+int InputEOF(const input_t *in)
+{
+    return in->eof;
+}
+
+byte GetByte(input_t *in, word *address, memory_t *memory)
 {
     byte b;
 
     (*address)++;
 
-    b = (byte)getc(fp);
+    if (in->pos < in->size)
+    {
+        b = in->data[in->pos++];
+    }
+    else
+    {
+        in->eof = TRUE;
+        b = 0xff;
+    }
+
     MemoryAddByte(memory, b);
     return b;
 }
 
-int GetRelative(FILE *fp, word *address, memory_t *memory)
+int GetRelative(input_t *in, word *address, memory_t *memory)
 {
     relative b;
 
-    b = (relative)GetByte(fp, address, memory);
+    b = (relative)GetByte(in, address, memory);
     return (int)b;
 }
 
-word GetRelativeAddress(FILE *fp, word *address, memory_t *memory)
+word GetRelativeAddress(input_t *in, word *address, memory_t *memory)
 {
     relative offset;
     word result;
 
-    offset = (relative)GetByte(fp, address, memory);
+    offset = (relative)GetByte(in, address, memory);
     result = *address + offset;
 
     return result;
 }
 
-word GetLSBWord(FILE *fp, word *address, memory_t *memory)
+word GetLSBWord(input_t *in, word *address, memory_t *memory)
 {
     word hi, lo;
 
-    lo = (word)GetByte(fp, address, memory);
-    hi = (word)GetByte(fp, address, memory);
+    lo = (word)GetByte(in, address, memory);
+    hi = (word)GetByte(in, address, memory);
 
     return lo | hi << 8;
 }
 
-word GetMSBWord(FILE *fp, word *address, memory_t *memory)
+word GetMSBWord(input_t *in, word *address, memory_t *memory)
 {
     word hi, lo;
 
-    hi = (word)GetByte(fp, address, memory);
-    lo = (word)GetByte(fp, address, memory);
+    hi = (word)GetByte(in, address, memory);
+    lo = (word)GetByte(in, address, memory);
 
     return lo | hi << 8;
 }
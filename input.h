@@ -26,15 +26,28 @@
 #ifndef DASM_INPUT_H
 #define DASM_INPUT_H
 
-#include <stdio.h>
 #include "global.h"
 #include "memory.h"
 
-byte GetByte(FILE *fp, word *address, memory_t *memory);
-int GetRelative(FILE *fp, word *address, memory_t *memory);
-word GetRelativeAddress(FILE *fp, word *address, memory_t *memory);
-word GetLSBWord(FILE *fp, word *address, memory_t *memory);
-word GetMSBWord(FILE *fp, word *address, memory_t *memory);
+/* An input stream over a block of memory.  Reading past the end sets eof
+   and returns 0xff.
+*/
+typedef struct
+{
+    const byte  *data;
+    ulong       size;
+    ulong       pos;
+    int         eof;
+} input_t;
+
+void InputInit(input_t *in, const byte *data, ulong size);
+int InputEOF(const input_t *in);
+
+byte GetByte(input_t *in, word *address, memory_t *memory);
+int GetRelative(input_t *in, word *address, memory_t *memory);
+word GetRelativeAddress(input_t *in, word *address, memory_t *memory);
+word GetLSBWord(input_t *in, word *address, memory_t *memory);
+word GetMSBWord(input_t *in, word *address, memory_t *memory);
 
 #endif
 
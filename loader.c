@@ -0,0 +1,769 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Loaders for snapshot and container formats.
+
+    Segments point straight into the mapped file wherever possible.  Only
+    compressed Z80 snapshot pages are expanded, into buffers owned by the
+    image.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "loader.h"
+#include "hexfile.h"
+
+#define PAGE_SIZE       0x4000
+
+#define SNA_HEADER      27
+#define SNA_48K         (SNA_HEADER + 3 * PAGE_SIZE)
+#define SNA_128K        (SNA_48K + 4 + 5 * PAGE_SIZE)
+#define SNA_128K_EXTRA  (SNA_48K + 4 + 6 * PAGE_SIZE)
+
+#define Z80_HEADER      30
+
+#define NES_HEADER      16
+#define NES_TRAINER     512
+
+#define T64_HEADER      0x40
+#define T64_ENTRY       32
+
+#define LSB(p)          ((word)(p)[0] | (word)(p)[1] << 8)
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    const char  *name;
+    const char  *extension;
+    const char  *magic;
+    const char  *cpu;
+    int         (*check)(const image_t *img);
+    int         (*load)(image_t *img, word origin);
+} format_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+static int Error(image_t *img, const char *msg)
+{
+    fprintf(stderr, "dasm: bad %s file: %s\n", img->format, msg);
+    return FALSE;
+}
+
+static int ExtensionIs(const char *path, const char *ext)
+{
+    const char *dot = strrchr(path, '.');
+
+    if (!dot)
+    {
+        return FALSE;
+    }
+
+    for(dot++; *dot && tolower((unsigned char)*dot) == *ext; dot++, ext++)
+    {
+    }
+
+    return !*dot && !*ext;
+}
+
+static void SetEntry(image_t *img, word entry)
+{
+    img->has_entry = TRUE;
+    img->entry = entry;
+}
+
+static int CompareSegment(const void *a, const void *b)
+{
+    const segment_t *sa = a;
+    const segment_t *sb = b;
+
+    if (sa->address != sb->address)
+    {
+        return sa->address < sb->address ? -1 : 1;
+    }
+
+    return sa->bank - sb->bank;
+}
+
+static void SortSegments(image_t *img)
+{
+    qsort(img->segment, (size_t)img->no, sizeof *img->segment,
+          CompareSegment);
+}
+
+/* Expands Z80 snapshot compression (ED ED count byte) from src into dest,
+   stopping at the version 1 end marker if end_marker is set.
+*/
+static void Expand(const byte *src, ulong len, byte *dest, ulong size,
+                   int end_marker)
+{
+    ulong i = 0;
+    ulong o = 0;
+
+    while(i < len && o < size)
+    {
+        if (i + 3 < len && src[i] == 0xed && src[i + 1] == 0xed)
+        {
+            int n = src[i + 2];
+
+            while(n-- && o < size)
+            {
+                dest[o++] = src[i + 3];
+            }
+
+            i += 4;
+        }
+        else if (end_marker && i + 3 < len && src[i] == 0 &&
+                 src[i + 1] == 0xed && src[i + 2] == 0xed && src[i + 3] == 0)
+        {
+            break;
+        }
+        else
+        {
+            dest[o++] = src[i++];
+        }
+    }
+}
+
+/* Finds the SYS address of a C64 BASIC loader stub at $0801
+*/
+static int BasicSys(const byte *data, ulong size, word *address)
+{
+    ulong f = 4;
+    word sys = 0;
+    int digits = 0;
+
+    while(f < size && data[f] == ' ')
+    {
+        f++;
+    }
+
+    if (f >= size || data[f++] != 0x9e)
+    {
+        return FALSE;
+    }
+
+    while(f < size && (data[f] == ' ' || data[f] == '('))
+    {
+        f++;
+    }
+
+    while(f < size && isdigit(data[f]))
+    {
+        sys = sys * 10 + (data[f++] - '0');
+        digits++;
+    }
+
+    *address = sys;
+
+    return digits > 0;
+}
+
+
+/* ---------------------------------------- CHECKS
+*/
+/* Formats without magic bytes are chosen by extension, so these look over
+   the file to make sure it is one before it is loaded as one.  A file that
+   fails is read as a raw binary.
+*/
+static int IsSNA(const image_t *img)
+{
+    return img->file_size == SNA_48K || img->file_size == SNA_128K ||
+           img->file_size == SNA_128K_EXTRA;
+}
+
+static int IsZ80(const image_t *img)
+{
+    const byte *h = img->file;
+    ulong size = img->file_size;
+    ulong extra;
+    ulong off;
+
+    if (size < Z80_HEADER)
+    {
+        return FALSE;
+    }
+
+    /* Version 1 is 48K of RAM, or compressed and ending in 00 ED ED 00
+    */
+    if (LSB(h + 6))
+    {
+        if (h[12] != 0xff && (h[12] & 0x20))
+        {
+            return size >= Z80_HEADER + 4 && h[size - 4] == 0 &&
+                   h[size - 3] == 0xed && h[size - 2] == 0xed &&
+                   h[size - 1] == 0;
+        }
+
+        return size == Z80_HEADER + 3 * PAGE_SIZE;
+    }
+
+    /* Later versions have a header extension of known length followed by
+       memory blocks that end with the file
+    */
+    if (size < Z80_HEADER + 2)
+    {
+        return FALSE;
+    }
+
+    extra = LSB(h + Z80_HEADER);
+
+    if (extra != 23 && extra != 54 && extra != 55)
+    {
+        return FALSE;
+    }
+
+    for(off = Z80_HEADER + 2 + extra; off + 3 <= size; )
+    {
+        ulong len = LSB(h + off);
+
+        off += 3 + (len == 0xffff ? PAGE_SIZE : len);
+    }
+
+    return off == size;
+}
+
+static int IsTAP(const image_t *img)
+{
+    const byte *h = img->file;
+    ulong size = img->file_size;
+    ulong off = 0;
+
+    if (size < 2)
+    {
+        return FALSE;
+    }
+
+    /* Every block must fit, end with a good checksum and the last must end
+       with the file
+    */
+    while(off + 2 <= size)
+    {
+        ulong len = LSB(h + off);
+        byte sum = 0;
+        ulong f;
+
+        off += 2;
+
+        if (len < 2 || off + len > size)
+        {
+            return FALSE;
+        }
+
+        for(f = 0; f < len; f++)
+        {
+            sum ^= h[off + f];
+        }
+
+        if (sum)
+        {
+            return FALSE;
+        }
+
+        off += len;
+    }
+
+    return off == size;
+}
+
+/* Returns the first character of a text file that is not white space
+*/
+static int FirstChar(const image_t *img)
+{
+    ulong f;
+
+    for(f = 0; f < img->file_size && isspace(img->file[f]); f++)
+    {
+    }
+
+    return f < img->file_size ? img->file[f] : EOF;
+}
+
+static int IsIntelHex(const image_t *img)
+{
+    return FirstChar(img) == ':';
+}
+
+static int IsSRecord(const image_t *img)
+{
+    return FirstChar(img) == 'S';
+}
+
+
+/* ---------------------------------------- LOADERS
+*/
+static int LoadBinary(image_t *img, word origin)
+{
+    ImageAddSegment(img, origin, img->file, img->file_size, NO_BANK);
+    return TRUE;
+}
+
+static int LoadSNA(image_t *img, word origin)
+{
+    const byte *h = img->file;
+    const byte *ram = h + SNA_HEADER;
+    word sp;
+    int paged;
+    int bank;
+    ulong off;
+
+    (void)origin;
+
+    if (img->file_size == SNA_48K)
+    {
+        ImageAddSegment(img, 0x4000, ram, 3 * PAGE_SIZE, NO_BANK);
+
+        /* The PC is on the stack, ready for a RETN
+        */
+        sp = LSB(h + 23);
+
+        if (sp >= 0x4000 && sp < 0xffff)
+        {
+            SetEntry(img, LSB(ram + sp - 0x4000));
+        }
+
+        return TRUE;
+    }
+
+    if (img->file_size != SNA_128K && img->file_size != SNA_128K_EXTRA)
+    {
+        return Error(img, "unknown size");
+    }
+
+    paged = h[SNA_48K + 2] & 7;
+
+    ImageAddSegment(img, 0x4000, ram, PAGE_SIZE, 5);
+    ImageAddSegment(img, 0x8000, ram + PAGE_SIZE, PAGE_SIZE, 2);
+    ImageAddSegment(img, 0xc000, ram + 2 * PAGE_SIZE, PAGE_SIZE, paged);
+
+    SetEntry(img, LSB(h + SNA_48K));
+
+    off = SNA_48K + 4;
+
+    for(bank = 0; bank < 8 && off + PAGE_SIZE <= img->file_size; bank++)
+    {
+        if (bank != 5 && bank != 2 && bank != paged)
+        {
+            ImageAddSegment(img, 0xc000, h + off, PAGE_SIZE, bank);
+            off += PAGE_SIZE;
+        }
+    }
+
+    SortSegments(img);
+
+    return TRUE;
+}
+
+static int LoadZ80(image_t *img, word origin)
+{
+    const byte *h = img->file;
+    ulong size = img->file_size;
+    ulong off;
+    ulong extra;
+    int is128;
+
+    (void)origin;
+
+    if (size < Z80_HEADER)
+    {
+        return Error(img, "short header");
+    }
+
+    /* Version 1 snapshots have the PC in the header
+    */
+    if (LSB(h + 6))
+    {
+        byte *ram;
+
+        SetEntry(img, LSB(h + 6));
+
+        if (h[12] != 0xff && (h[12] & 0x20))
+        {
+            ram = ImageAlloc(img, 3 * PAGE_SIZE);
+            Expand(h + Z80_HEADER, size - Z80_HEADER, ram, 3 * PAGE_SIZE,
+                   TRUE);
+            ImageAddSegment(img, 0x4000, ram, 3 * PAGE_SIZE, NO_BANK);
+        }
+        else
+        {
+            ImageAddSegment(img, 0x4000, h + Z80_HEADER,
+                            size - Z80_HEADER < 3 * PAGE_SIZE ?
+                                size - Z80_HEADER : 3 * PAGE_SIZE, NO_BANK);
+        }
+
+        return TRUE;
+    }
+
+    if (size < Z80_HEADER + 5)
+    {
+        return Error(img, "short header");
+    }
+
+    extra = LSB(h + Z80_HEADER);
+    off = Z80_HEADER + 2 + extra;
+
+    SetEntry(img, LSB(h + Z80_HEADER + 2));
+
+    is128 = extra == 23 ? h[34] >= 3 : h[34] >= 4;
+
+    while(off + 3 <= size)
+    {
+        ulong len = LSB(h + off);
+        int page = h[off + 2];
+        const byte *data = h + off + 3;
+        int compressed = len != 0xffff;
+        word address;
+        int bank;
+
+        off += 3;
+
+        if (!compressed)
+        {
+            len = PAGE_SIZE;
+        }
+
+        if (off + len > size)
+        {
+            return Error(img, "truncated memory block");
+        }
+
+        if (is128)
+        {
+            /* Pages 0 to 2 are ROMs and 3 to 10 RAM banks 0 to 7
+            */
+            if (page < 3 || page > 10)
+            {
+                off += len;
+                continue;
+            }
+
+            bank = page - 3;
+
+            address = bank == 5 ? 0x4000 : bank == 2 ? 0x8000 : 0xc000;
+        }
+        else
+        {
+            bank = NO_BANK;
+
+            switch(page)
+            {
+                case 4:
+                    address = 0x8000;
+                    break;
+
+                case 5:
+                    address = 0xc000;
+                    break;
+
+                case 8:
+                    address = 0x4000;
+                    break;
+
+                default:
+                    off += len;
+                    continue;
+            }
+        }
+
+        if (!compressed)
+        {
+            ImageAddSegment(img, address, data, PAGE_SIZE, bank);
+        }
+        else
+        {
+            byte *ram = ImageAlloc(img, PAGE_SIZE);
+
+            Expand(data, len, ram, PAGE_SIZE, FALSE);
+            ImageAddSegment(img, address, ram, PAGE_SIZE, bank);
+        }
+
+        off += len;
+    }
+
+    SortSegments(img);
+
+    return TRUE;
+}
+
+static int LoadTAP(image_t *img, word origin)
+{
+    const byte *h = img->file;
+    ulong size = img->file_size;
+    ulong off = 0;
+    int code = FALSE;
+    word start = 0;
+
+    (void)origin;
+
+    while(off + 2 <= size)
+    {
+        ulong len = LSB(h + off);
+        const byte *block = h + off + 2;
+
+        off += 2 + len;
+
+        if (len < 2 || off > size)
+        {
+            return Error(img, "truncated block");
+        }
+
+        if (block[0] == 0x00 && len == 19)
+        {
+            /* Header.  Only CODE blocks (type 3) hold machine code.
+            */
+            code = block[1] == 3;
+            start = LSB(block + 14);
+        }
+        else if (block[0] == 0xff && code)
+        {
+            ImageAddSegment(img, start, block + 1, len - 2, NO_BANK);
+            code = FALSE;
+        }
+    }
+
+    if (img->no == 0)
+    {
+        return Error(img, "no CODE blocks");
+    }
+
+    return TRUE;
+}
+
+static int LoadPRG(image_t *img, word origin)
+{
+    word address;
+    word sys;
+
+    (void)origin;
+
+    if (img->file_size < 2)
+    {
+        return Error(img, "no load address");
+    }
+
+    address = LSB(img->file);
+
+    ImageAddSegment(img, address, img->file + 2, img->file_size - 2,
+                    NO_BANK);
+
+    if (address == 0x0801 &&
+            BasicSys(img->file + 2, img->file_size - 2, &sys))
+    {
+        SetEntry(img, sys);
+    }
+
+    return TRUE;
+}
+
+static int LoadT64(image_t *img, word origin)
+{
+    const byte *h = img->file;
+    ulong size = img->file_size;
+    int entries;
+    int f;
+
+    (void)origin;
+
+    if (size < T64_HEADER)
+    {
+        return Error(img, "short header");
+    }
+
+    entries = LSB(h + 0x24);
+
+    if (entries == 0)
+    {
+        entries = LSB(h + 0x22);
+    }
+
+    for(f = 0; f < entries; f++)
+    {
+        const byte *e = h + T64_HEADER + f * T64_ENTRY;
+        ulong off;
+        ulong len;
+        word sys;
+
+        if (e + T64_ENTRY > h + size)
+        {
+            return Error(img, "truncated directory");
+        }
+
+        if (e[0] == 0)
+        {
+            continue;
+        }
+
+        off = LSB(e + 8) | (ulong)LSB(e + 10) << 16;
+        len = (LSB(e + 4) - LSB(e + 2)) & 0xffff;
+
+        if (off >= size)
+        {
+            return Error(img, "file offset past end of image");
+        }
+
+        /* Many T64 writers get the end address wrong
+        */
+        if (off + len > size)
+        {
+            len = size - off;
+        }
+
+        ImageAddSegment(img, LSB(e + 2), h + off, len, NO_BANK);
+
+        if (!img->has_entry && LSB(e + 2) == 0x0801 &&
+                BasicSys(h + off, len, &sys))
+        {
+            SetEntry(img, sys);
+        }
+    }
+
+    return TRUE;
+}
+
+static int LoadNES(image_t *img, word origin)
+{
+    const byte *h = img->file;
+    const byte *prg;
+    int banks;
+    int mapper;
+    int bank;
+
+    (void)origin;
+
+    if (img->file_size < NES_HEADER)
+    {
+        return Error(img, "short header");
+    }
+
+    banks = h[4];
+    mapper = h[6] >> 4 | (h[7] & 0xf0);
+    prg = h + NES_HEADER + (h[6] & 0x04 ? NES_TRAINER : 0);
+
+    if (banks == 0 || prg + banks * PAGE_SIZE > h + img->file_size)
+    {
+        return Error(img, "truncated PRG ROM");
+    }
+
+    if (banks == 1)
+    {
+        /* Mirrored at $8000 and $c000, the vectors are in the upper copy
+        */
+        ImageAddSegment(img, 0xc000, prg, PAGE_SIZE, NO_BANK);
+    }
+    else if (banks == 2 && mapper == 0)
+    {
+        ImageAddSegment(img, 0x8000, prg, 2 * PAGE_SIZE, NO_BANK);
+    }
+    else
+    {
+        /* Assume the common arrangement of switchable banks at $8000 and
+           the last bank fixed at $c000.
+        */
+        for(bank = 0; bank < banks - 1; bank++)
+        {
+            ImageAddSegment(img, 0x8000, prg + bank * PAGE_SIZE, PAGE_SIZE,
+                            bank);
+        }
+
+        ImageAddSegment(img, 0xc000, prg + bank * PAGE_SIZE, PAGE_SIZE,
+                        bank);
+    }
+
+    SetEntry(img, LSB(prg + banks * PAGE_SIZE - 4));
+
+    return TRUE;
+}
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static const format_t format_table[] =
+{
+    {"iNES",         "nes",  "NES\x1a",  "6502", NULL,       LoadNES},
+    {"T64",          "t64",  "C64 tape image file",
+                                         "6502", NULL,       LoadT64},
+    {"T64",          "t64",  "C64S tape",
+                                         "6502", NULL,       LoadT64},
+    {"SNA snapshot", "sna",  NULL,       "Z80",  IsSNA,      LoadSNA},
+    {"Z80 snapshot", "z80",  NULL,       "Z80",  IsZ80,      LoadZ80},
+    {"TAP",          "tap",  NULL,       "Z80",  IsTAP,      LoadTAP},
+    {"PRG",          "prg",  NULL,       "6502", NULL,       LoadPRG},
+    {"Intel HEX",    "hex",  NULL,       NULL,   IsIntelHex, LoadIntelHex},
+    {"Intel HEX",    "ihx",  NULL,       NULL,   IsIntelHex, LoadIntelHex},
+    {"Intel HEX",    "ihex", NULL,       NULL,   IsIntelHex, LoadIntelHex},
+    {"S-record",     "srec", NULL,       NULL,   IsSRecord,  LoadSRecord},
+    {"S-record",     "s19",  NULL,       NULL,   IsSRecord,  LoadSRecord},
+    {"S-record",     "s28",  NULL,       NULL,   IsSRecord,  LoadSRecord},
+    {"S-record",     "s37",  NULL,       NULL,   IsSRecord,  LoadSRecord},
+    {"S-record",     "mot",  NULL,       NULL,   IsSRecord,  LoadSRecord},
+    {NULL}
+};
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int LoadImage(image_t *img, const char *path, word origin)
+{
+    int f;
+
+    for(f = 0; format_table[f].name; f++)
+    {
+        const format_t *fmt = format_table + f;
+        int match;
+
+        if (fmt->magic)
+        {
+            size_t len = strlen(fmt->magic);
+
+            match = img->file_size >= len &&
+                        memcmp(img->file, fmt->magic, len) == 0;
+        }
+        else
+        {
+            match = ExtensionIs(path, fmt->extension);
+        }
+
+        if (match && fmt->check && !fmt->check(img))
+        {
+            match = FALSE;
+        }
+
+        if (match)
+        {
+            img->format = fmt->name;
+            img->cpu = fmt->cpu;
+
+            return fmt->load(img, origin);
+        }
+    }
+
+    return LoadBinary(img, origin);
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
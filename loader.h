@@ -0,0 +1,43 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Loaders for snapshot and container formats.
+
+*/
+
+#ifndef DASM_LOADER_H
+#define DASM_LOADER_H
+
+#include "global.h"
+#include "image.h"
+
+/* Recognises the format of an opened image by its magic bytes or file name
+   and fills in its segments, entry point and CPU.  Files that are not in a
+   known format become a single segment at origin.  Returns FALSE after
+   reporting an error if the file is damaged.
+*/
+int LoadImage(image_t *img, const char *path, word origin);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
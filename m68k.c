@@ -0,0 +1,1305 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    68000 disassembly
+
+    The instructions are given as patterns of fixed and free bits of the
+    operation word.  M68K_Init() expands them into a table holding the
+    pattern for each of the 65536 operation words, with the effective
+    addresses each pattern allows already checked, so decoding starts with
+    a single lookup.  Each operand is then read and printed by the handlers
+    for its form, which are tables indexed by the addressing mode.
+
+    Instructions are keyed by the high byte of their operation word, which
+    holds the instruction line, its first register and often its size.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "m68k.h"
+#include "decode.h"
+#include "output.h"
+#include "input.h"
+#include "memory.h"
+
+/* Characters in the text of the longest instruction
+*/
+#define MAX_TEXT        128
+
+/* Address bits of the 68000
+*/
+#define ADDRESS_MASK    0xffffffUL
+
+
+/* ---------------------------------------- TYPES
+*/
+
+/* The forms an operand can take.  The first twelve are the addressing
+   modes, in the order the mode and register fields of an effective address
+   give them.
+*/
+typedef enum
+{
+    eFormDn,            /* d0 */
+    eFormAn,            /* a0 */
+    eFormInd,           /* (a0) */
+    eFormPost,          /* (a0)+ */
+    eFormPre,           /* -(a0) */
+    eFormDisp,          /* $10(a0) */
+    eFormIndex,         /* $10(a0,d0.w) */
+    eFormAbsW,          /* $1234.w */
+    eFormAbsL,          /* $123456 */
+    eFormPCDisp,        /* $123456(pc) */
+    eFormPCIndex,       /* $123456(pc,d0.w) */
+    eFormImm,           /* #$12 */
+    eFormQuick,         /* #8 */
+    eFormMoveq,         /* #-$01 */
+    eFormTarget,        /* $123456 */
+    eFormRegList,       /* d0-d3/a0 */
+    eFormCCR,
+    eFormSR,
+    eFormUSP,
+    eFormNone,
+    eNumForms
+} form_t;
+
+#define MODES           (eFormImm + 1)
+#define M(f)            (1 << (f))
+
+#define ALL             (M(MODES) - 1)
+#define DATA            (ALL & ~M(eFormAn))
+#define ALT             (M(eFormDn) | M(eFormAn) | M(eFormInd) | \
+                         M(eFormPost) | M(eFormPre) | M(eFormDisp) | \
+                         M(eFormIndex) | M(eFormAbsW) | M(eFormAbsL))
+#define DALT            (ALT & ~M(eFormAn))
+#define MALT            (DALT & ~M(eFormDn))
+#define CTRL            (M(eFormInd) | M(eFormDisp) | M(eFormIndex) | \
+                         M(eFormAbsW) | M(eFormAbsL) | M(eFormPCDisp) | \
+                         M(eFormPCIndex))
+#define CALT            (CTRL & ALT)
+
+/* Where an operand comes from in an instruction
+*/
+typedef enum
+{
+    eOpNone,
+    eOpEA,              /* Mode and register in bits 5-0 */
+    eOpMoveEA,          /* Register and mode in bits 11-6 */
+    eOpDn,              /* Register in bits 11-9 */
+    eOpAn,
+    eOpPre,
+    eOpPost,
+    eOpDn0,             /* Register in bits 2-0 */
+    eOpAn0,
+    eOpPre0,
+    eOpPost0,
+    eOpDisp0,
+    eOpImm,             /* Immediate of the instruction's size */
+    eOpImmB,
+    eOpImmW,
+    eOpQuick,           /* 1-8 in bits 11-9 */
+    eOpMoveq,           /* Signed byte in bits 7-0 */
+    eOpTrap,            /* Vector in bits 3-0 */
+    eOpBranch,          /* Byte displacement, or a word if it is zero */
+    eOpDbcc,            /* Word displacement */
+    eOpRegList,         /* Register mask in the first extension word */
+    eOpCCR,
+    eOpSR,
+    eOpUSP
+} source_t;
+
+/* How the size of an instruction is given
+*/
+typedef enum
+{
+    eSzNone,
+    eSzB,
+    eSzW,
+    eSzL,
+    eSz76,              /* Bits 7-6 as byte, word or long */
+    eSzMove,            /* Bits 13-12 as byte, long or word */
+    eSz6                /* Bit 6 as word or long */
+} size_rule_t;
+
+typedef struct
+{
+    word        mask;
+    word        match;
+    const char  *name;
+    byte        size;           /* size_rule_t */
+    byte        src;            /* source_t */
+    byte        dst;            /* source_t */
+    byte        flow;           /* flow_t */
+    word        src_modes;      /* Modes allowed for an eOpEA source */
+    word        dst_modes;      /* Modes allowed for an eOpEA destination */
+} pattern_t;
+
+typedef struct
+{
+    byte        form;           /* form_t */
+    byte        reg;
+    byte        size;           /* Bytes of an immediate */
+    word        index;          /* Brief extension word of the index forms */
+    long        disp;
+    ulong       value;          /* Address, target, immediate or mask */
+} operand_t;
+
+typedef struct
+{
+    const byte  *data;
+    ulong       size;
+    word        address;
+    int         pos;            /* Bytes read */
+} fetch_t;
+
+typedef struct
+{
+    const pattern_t     *pattern;       /* NULL if illegal */
+    word                op;
+    int                 size;           /* Bytes, or 0 if unsized */
+    operand_t           src;
+    operand_t           dst;
+} inst_t;
+
+
+/* ---------------------------------------- GLOBALS
+*/
+#define NO      eOpNone
+#define EA      eOpEA
+#define N       eFlowNext
+
+static const pattern_t patterns[] =
+{
+    /* Line 0: bit operations, movep and immediates
+    */
+    {0xffff, 0x003c, "ori",     eSzNone, eOpImmB,  eOpCCR,  N, 0, 0},
+    {0xffff, 0x007c, "ori",     eSzNone, eOpImmW,  eOpSR,   N, 0, 0},
+    {0xffff, 0x023c, "andi",    eSzNone, eOpImmB,  eOpCCR,  N, 0, 0},
+    {0xffff, 0x027c, "andi",    eSzNone, eOpImmW,  eOpSR,   N, 0, 0},
+    {0xffff, 0x0a3c, "eori",    eSzNone, eOpImmB,  eOpCCR,  N, 0, 0},
+    {0xffff, 0x0a7c, "eori",    eSzNone, eOpImmW,  eOpSR,   N, 0, 0},
+    {0xf1f8, 0x0108, "movep",   eSzW,    eOpDisp0, eOpDn,   N, 0, 0},
+    {0xf1f8, 0x0148, "movep",   eSzL,    eOpDisp0, eOpDn,   N, 0, 0},
+    {0xf1f8, 0x0188, "movep",   eSzW,    eOpDn,    eOpDisp0, N, 0, 0},
+    {0xf1f8, 0x01c8, "movep",   eSzL,    eOpDn,    eOpDisp0, N, 0, 0},
+    {0xf1c0, 0x0100, "btst",    eSzNone, eOpDn,    EA,      N, 0, DATA},
+    {0xf1c0, 0x0140, "bchg",    eSzNone, eOpDn,    EA,      N, 0, DALT},
+    {0xf1c0, 0x0180, "bclr",    eSzNone, eOpDn,    EA,      N, 0, DALT},
+    {0xf1c0, 0x01c0, "bset",    eSzNone, eOpDn,    EA,      N, 0, DALT},
+    {0xffc0, 0x0800, "btst",    eSzNone, eOpImmB,  EA,      N, 0,
+                                                    DATA & ~M(eFormImm)},
+    {0xffc0, 0x0840, "bchg",    eSzNone, eOpImmB,  EA,      N, 0, DALT},
+    {0xffc0, 0x0880, "bclr",    eSzNone, eOpImmB,  EA,      N, 0, DALT},
+    {0xffc0, 0x08c0, "bset",    eSzNone, eOpImmB,  EA,      N, 0, DALT},
+    {0xff00, 0x0000, "ori",     eSz76,   eOpImm,   EA,      N, 0, DALT},
+    {0xff00, 0x0200, "andi",    eSz76,   eOpImm,   EA,      N, 0, DALT},
+    {0xff00, 0x0400, "subi",    eSz76,   eOpImm,   EA,      N, 0, DALT},
+    {0xff00, 0x0600, "addi",    eSz76,   eOpImm,   EA,      N, 0, DALT},
+    {0xff00, 0x0a00, "eori",    eSz76,   eOpImm,   EA,      N, 0, DALT},
+    {0xff00, 0x0c00, "cmpi",    eSz76,   eOpImm,   EA,      N, 0, DALT},
+
+    /* Lines 1-3: moves
+    */
+    {0xf1c0, 0x2040, "movea",   eSzL,    EA,       eOpAn,   N, ALL, 0},
+    {0xf1c0, 0x3040, "movea",   eSzW,    EA,       eOpAn,   N, ALL, 0},
+    {0xc000, 0x0000, "move",    eSzMove, EA,       eOpMoveEA, N, ALL, DALT},
+
+    /* Line 4: miscellaneous
+    */
+    {0xffc0, 0x40c0, "move",    eSzW,    eOpSR,    EA,      N, 0, DALT},
+    {0xff00, 0x4000, "negx",    eSz76,   EA,       NO,      N, DALT, 0},
+    {0xff00, 0x4200, "clr",     eSz76,   EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x44c0, "move",    eSzW,    EA,       eOpCCR,  N, DATA, 0},
+    {0xff00, 0x4400, "neg",     eSz76,   EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x46c0, "move",    eSzW,    EA,       eOpSR,   N, DATA, 0},
+    {0xff00, 0x4600, "not",     eSz76,   EA,       NO,      N, DALT, 0},
+    {0xfff8, 0x4840, "swap",    eSzNone, eOpDn0,   NO,      N, 0, 0},
+    {0xfff8, 0x4880, "ext",     eSzW,    eOpDn0,   NO,      N, 0, 0},
+    {0xfff8, 0x48c0, "ext",     eSzL,    eOpDn0,   NO,      N, 0, 0},
+    {0xffc0, 0x4800, "nbcd",    eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x4840, "pea",     eSzNone, EA,       NO,      N, CTRL, 0},
+    {0xff80, 0x4880, "movem",   eSz6,    eOpRegList, EA,    N, 0,
+                                                    CALT | M(eFormPre)},
+    {0xffff, 0x4afc, "illegal", eSzNone, NO,       NO,      eFlowHalt, 0, 0},
+    {0xffc0, 0x4ac0, "tas",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xff00, 0x4a00, "tst",     eSz76,   EA,       NO,      N, DALT, 0},
+    {0xff80, 0x4c80, "movem",   eSz6,    EA,       eOpRegList, N,
+                                                    CTRL | M(eFormPost), 0},
+    {0xfff0, 0x4e40, "trap",    eSzNone, eOpTrap,  NO,      eFlowCall, 0, 0},
+    {0xfff8, 0x4e50, "link",    eSzNone, eOpAn0,   eOpImmW, N, 0, 0},
+    {0xfff8, 0x4e58, "unlk",    eSzNone, eOpAn0,   NO,      N, 0, 0},
+    {0xfff8, 0x4e60, "move",    eSzL,    eOpAn0,   eOpUSP,  N, 0, 0},
+    {0xfff8, 0x4e68, "move",    eSzL,    eOpUSP,   eOpAn0,  N, 0, 0},
+    {0xffff, 0x4e70, "reset",   eSzNone, NO,       NO,      N, 0, 0},
+    {0xffff, 0x4e71, "nop",     eSzNone, NO,       NO,      N, 0, 0},
+    {0xffff, 0x4e72, "stop",    eSzNone, eOpImmW,  NO,      eFlowHalt, 0, 0},
+    {0xffff, 0x4e73, "rte",     eSzNone, NO,       NO,      eFlowReturn, 0, 0},
+    {0xffff, 0x4e75, "rts",     eSzNone, NO,       NO,      eFlowReturn, 0, 0},
+    {0xffff, 0x4e76, "trapv",   eSzNone, NO,       NO,      N, 0, 0},
+    {0xffff, 0x4e77, "rtr",     eSzNone, NO,       NO,      eFlowReturn, 0, 0},
+    {0xffc0, 0x4e80, "jsr",     eSzNone, EA,       NO,   eFlowCall, CTRL, 0},
+    {0xffc0, 0x4ec0, "jmp",     eSzNone, EA,       NO,   eFlowJump, CTRL, 0},
+    {0xf1c0, 0x4180, "chk",     eSzW,    EA,       eOpDn,   N, DATA, 0},
+    {0xf1c0, 0x41c0, "lea",     eSzNone, EA,       eOpAn,   N, CTRL, 0},
+
+    /* Line 5: quick arithmetic, DBcc and Scc
+    */
+    {0xfff8, 0x50c8, "dbt",     eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x51c8, "dbra",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x52c8, "dbhi",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x53c8, "dbls",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x54c8, "dbcc",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x55c8, "dbcs",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x56c8, "dbne",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x57c8, "dbeq",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x58c8, "dbvc",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x59c8, "dbvs",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5ac8, "dbpl",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5bc8, "dbmi",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5cc8, "dbge",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5dc8, "dblt",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5ec8, "dbgt",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xfff8, 0x5fc8, "dble",    eSzNone, eOpDn0, eOpDbcc, eFlowBranch, 0, 0},
+    {0xffc0, 0x50c0, "st",      eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x51c0, "sf",      eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x52c0, "shi",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x53c0, "sls",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x54c0, "scc",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x55c0, "scs",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x56c0, "sne",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x57c0, "seq",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x58c0, "svc",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x59c0, "svs",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5ac0, "spl",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5bc0, "smi",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5cc0, "sge",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5dc0, "slt",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5ec0, "sgt",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xffc0, 0x5fc0, "sle",     eSzNone, EA,       NO,      N, DALT, 0},
+    {0xf100, 0x5000, "addq",    eSz76,   eOpQuick, EA,      N, 0, ALT},
+    {0xf100, 0x5100, "subq",    eSz76,   eOpQuick, EA,      N, 0, ALT},
+
+    /* Line 6: branches
+    */
+    {0xff00, 0x6000, "bra",     eSzNone, eOpBranch, NO,     eFlowJump, 0, 0},
+    {0xff00, 0x6100, "bsr",     eSzNone, eOpBranch, NO,     eFlowCall, 0, 0},
+    {0xff00, 0x6200, "bhi",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6300, "bls",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6400, "bcc",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6500, "bcs",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6600, "bne",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6700, "beq",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6800, "bvc",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6900, "bvs",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6a00, "bpl",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6b00, "bmi",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6c00, "bge",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6d00, "blt",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6e00, "bgt",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+    {0xff00, 0x6f00, "ble",     eSzNone, eOpBranch, NO,     eFlowBranch, 0, 0},
+
+    /* Line 7: moveq
+    */
+    {0xf100, 0x7000, "moveq",   eSzNone, eOpMoveq, eOpDn,   N, 0, 0},
+
+    /* Line 8: or, division and sbcd
+    */
+    {0xf1c0, 0x80c0, "divu",    eSzW,    EA,       eOpDn,   N, DATA, 0},
+    {0xf1c0, 0x81c0, "divs",    eSzW,    EA,       eOpDn,   N, DATA, 0},
+    {0xf1f8, 0x8100, "sbcd",    eSzNone, eOpDn0,   eOpDn,   N, 0, 0},
+    {0xf1f8, 0x8108, "sbcd",    eSzNone, eOpPre0,  eOpPre,  N, 0, 0},
+    {0xf100, 0x8000, "or",      eSz76,   EA,       eOpDn,   N, DATA, 0},
+    {0xf100, 0x8100, "or",      eSz76,   eOpDn,    EA,      N, 0, MALT},
+
+    /* Line 9: subtraction
+    */
+    {0xf1c0, 0x90c0, "suba",    eSzW,    EA,       eOpAn,   N, ALL, 0},
+    {0xf1c0, 0x91c0, "suba",    eSzL,    EA,       eOpAn,   N, ALL, 0},
+    {0xf138, 0x9100, "subx",    eSz76,   eOpDn0,   eOpDn,   N, 0, 0},
+    {0xf138, 0x9108, "subx",    eSz76,   eOpPre0,  eOpPre,  N, 0, 0},
+    {0xf100, 0x9000, "sub",     eSz76,   EA,       eOpDn,   N, ALL, 0},
+    {0xf100, 0x9100, "sub",     eSz76,   eOpDn,    EA,      N, 0, MALT},
+
+    /* Line B: comparison and eor
+    */
+    {0xf1c0, 0xb0c0, "cmpa",    eSzW,    EA,       eOpAn,   N, ALL, 0},
+    {0xf1c0, 0xb1c0, "cmpa",    eSzL,    EA,       eOpAn,   N, ALL, 0},
+    {0xf138, 0xb108, "cmpm",    eSz76,   eOpPost0, eOpPost, N, 0, 0},
+    {0xf100, 0xb000, "cmp",     eSz76,   EA,       eOpDn,   N, ALL, 0},
+    {0xf100, 0xb100, "eor",     eSz76,   eOpDn,    EA,      N, 0, DALT},
+
+    /* Line C: and, multiplication, abcd and exg
+    */
+    {0xf1c0, 0xc0c0, "mulu",    eSzW,    EA,       eOpDn,   N, DATA, 0},
+    {0xf1c0, 0xc1c0, "muls",    eSzW,    EA,       eOpDn,   N, DATA, 0},
+    {0xf1f8, 0xc100, "abcd",    eSzNone, eOpDn0,   eOpDn,   N, 0, 0},
+    {0xf1f8, 0xc108, "abcd",    eSzNone, eOpPre0,  eOpPre,  N, 0, 0},
+    {0xf1f8, 0xc140, "exg",     eSzNone, eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf1f8, 0xc148, "exg",     eSzNone, eOpAn,    eOpAn0,  N, 0, 0},
+    {0xf1f8, 0xc188, "exg",     eSzNone, eOpDn,    eOpAn0,  N, 0, 0},
+    {0xf100, 0xc000, "and",     eSz76,   EA,       eOpDn,   N, DATA, 0},
+    {0xf100, 0xc100, "and",     eSz76,   eOpDn,    EA,      N, 0, MALT},
+
+    /* Line D: addition
+    */
+    {0xf1c0, 0xd0c0, "adda",    eSzW,    EA,       eOpAn,   N, ALL, 0},
+    {0xf1c0, 0xd1c0, "adda",    eSzL,    EA,       eOpAn,   N, ALL, 0},
+    {0xf138, 0xd100, "addx",    eSz76,   eOpDn0,   eOpDn,   N, 0, 0},
+    {0xf138, 0xd108, "addx",    eSz76,   eOpPre0,  eOpPre,  N, 0, 0},
+    {0xf100, 0xd000, "add",     eSz76,   EA,       eOpDn,   N, ALL, 0},
+    {0xf100, 0xd100, "add",     eSz76,   eOpDn,    EA,      N, 0, MALT},
+
+    /* Line E: shifts and rotates of memory, then of registers by a count
+       or by a register
+    */
+    {0xffc0, 0xe0c0, "asr",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe1c0, "asl",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe2c0, "lsr",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe3c0, "lsl",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe4c0, "roxr",    eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe5c0, "roxl",    eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe6c0, "ror",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xffc0, 0xe7c0, "rol",     eSzW,    EA,       NO,      N, MALT, 0},
+    {0xf138, 0xe000, "asr",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe100, "asl",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe008, "lsr",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe108, "lsl",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe010, "roxr",    eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe110, "roxl",    eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe018, "ror",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe118, "rol",     eSz76,   eOpQuick, eOpDn0,  N, 0, 0},
+    {0xf138, 0xe020, "asr",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe120, "asl",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe028, "lsr",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe128, "lsl",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe030, "roxr",    eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe130, "roxl",    eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe038, "ror",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+    {0xf138, 0xe138, "rol",     eSz76,   eOpDn,    eOpDn0,  N, 0, 0},
+
+    {0}
+};
+
+#undef NO
+#undef EA
+#undef N
+
+/* The pattern of each operation word plus one, or zero if it is illegal
+*/
+static byte optable[0x10000];
+
+/* Most common operation word high bytes in typical code, most frequent
+   first
+*/
+const word M68K_Model[] =
+{
+    0x4e, 0x20, 0x61, 0x67, 0x66, 0x70, 0x4a, 0x2f,
+    0x30, 0x60, 0x48, 0x4c, 0x41, 0x43, 0x22, 0x32,
+    0x52, 0x53, 0x42, 0x0c, 0x72, 0x24, 0x58, 0x2d,
+    0x2c, 0x21, 0x23, 0x26, 0x28, 0x3f, 0xd0, 0x90,
+    0xb0, 0x6e, 0x6c, 0x6d, 0x6f, 0x65, 0x64, 0x6a,
+    0x6b, 0x45, 0x47, 0x49, 0x4b, 0x4d, 0x10, 0x12,
+    0x11, 0x13, 0x31, 0x33, 0x3d, 0x02, 0x08, 0x51,
+    0x74, 0x76, 0x7e, 0xe5, 0xe3, 0xe9, 0xc0, 0x80,
+    0xd1, 0x91, 0xb1, 0x56, 0x57,
+    MODEL_END
+};
+
+static const char *const imm_format[] =
+{
+    "#$%2.2x",
+    "#$%2.2x",
+    "#$%4.4x",
+    "#$%8.8x",
+    "#$%8.8x"
+};
+
+static const char *const index_format[2][2] =
+{
+    {"d%u.w)", "d%u.l)"},
+    {"a%u.w)", "a%u.l)"}
+};
+
+static const char *const suffix_format[] =
+{
+    "",
+    ".b",
+    ".w",
+    "",
+    ".l"
+};
+
+
+/* ---------------------------------------- UTILS
+*/
+static long SignExtend(ulong value, int bits)
+{
+    ulong sign = 1UL << (bits - 1);
+
+    value &= (sign << 1) - 1;
+
+    return value & sign ? (long)value - (long)(sign << 1) : (long)value;
+}
+
+/* Returns the mode of the 6 bit effective address ea, or MODES if it has
+   none
+*/
+static int Mode(int ea)
+{
+    int mode = ea >> 3;
+    int reg = ea & 7;
+
+    return mode < 7 ? mode : reg <= 4 ? 7 + reg : MODES;
+}
+
+static int Size(int rule, word op)
+{
+    static const int bits76[] = {1, 2, 4, -1};
+    static const int move[] = {-1, 1, 4, 2};
+
+    switch(rule)
+    {
+        case eSzB:
+            return 1;
+
+        case eSzW:
+            return 2;
+
+        case eSzL:
+            return 4;
+
+        case eSz76:
+            return bits76[(op >> 6) & 3];
+
+        case eSzMove:
+            return move[(op >> 12) & 3];
+
+        case eSz6:
+            return op & 0x40 ? 4 : 2;
+
+        default:
+            return 0;
+    }
+}
+
+/* Returns the mode of the effective address an operand takes from op, or
+   -1 if it takes none
+*/
+static int OperandMode(int source, word op)
+{
+    switch(source)
+    {
+        case eOpEA:
+            return Mode(op & 0x3f);
+
+        case eOpMoveEA:
+            return Mode(((op >> 3) & 0x38) | ((op >> 9) & 7));
+
+        default:
+            return -1;
+    }
+}
+
+static int Allowed(const pattern_t *p, word op)
+{
+    int size = Size(p->size, op);
+    int src = OperandMode(p->src, op);
+    int dst = OperandMode(p->dst, op);
+
+    if (size < 0)
+    {
+        return FALSE;
+    }
+
+    if (src != -1 && (!(p->src_modes & M(src)) ||
+                      (src == eFormAn && size == 1)))
+    {
+        return FALSE;
+    }
+
+    if (dst != -1 && (!(p->dst_modes & M(dst)) ||
+                      (dst == eFormAn && size == 1)))
+    {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static int Word(fetch_t *f, ulong *value)
+{
+    if ((ulong)f->pos + 2 > f->size)
+    {
+        return FALSE;
+    }
+
+    *value = (ulong)f->data[f->pos] << 8 | f->data[f->pos + 1];
+    f->pos += 2;
+
+    return TRUE;
+}
+
+static int Long(fetch_t *f, ulong *value)
+{
+    ulong hi;
+    ulong lo;
+
+    if (!Word(f, &hi) || !Word(f, &lo))
+    {
+        return FALSE;
+    }
+
+    *value = hi << 16 | lo;
+
+    return TRUE;
+}
+
+/* Effective address extension words, read by the handler for the mode
+*/
+static int ReadNone(fetch_t *f, operand_t *o)
+{
+    (void)f;
+    (void)o;
+
+    return TRUE;
+}
+
+static int ReadDisp(fetch_t *f, operand_t *o)
+{
+    ulong w;
+
+    if (!Word(f, &w))
+    {
+        return FALSE;
+    }
+
+    o->disp = SignExtend(w, 16);
+
+    return TRUE;
+}
+
+static int ReadIndex(fetch_t *f, operand_t *o)
+{
+    ulong w;
+
+    if (!Word(f, &w))
+    {
+        return FALSE;
+    }
+
+    o->index = (word)w;
+    o->disp = SignExtend(w, 8);
+
+    return TRUE;
+}
+
+static int ReadAbsW(fetch_t *f, operand_t *o)
+{
+    return Word(f, &o->value);
+}
+
+static int ReadAbsL(fetch_t *f, operand_t *o)
+{
+    return Long(f, &o->value);
+}
+
+static int ReadPCDisp(fetch_t *f, operand_t *o)
+{
+    word pc = f->address + (word)f->pos;
+
+    if (!ReadDisp(f, o))
+    {
+        return FALSE;
+    }
+
+    o->value = (pc + (ulong)o->disp) & ADDRESS_MASK;
+
+    return TRUE;
+}
+
+static int ReadPCIndex(fetch_t *f, operand_t *o)
+{
+    word pc = f->address + (word)f->pos;
+
+    if (!ReadIndex(f, o))
+    {
+        return FALSE;
+    }
+
+    o->value = (pc + (ulong)o->disp) & ADDRESS_MASK;
+
+    return TRUE;
+}
+
+static int ReadImm(fetch_t *f, operand_t *o)
+{
+    if (o->size == 4)
+    {
+        return Long(f, &o->value);
+    }
+
+    if (!Word(f, &o->value))
+    {
+        return FALSE;
+    }
+
+    if (o->size == 1)
+    {
+        o->value &= 0xff;
+    }
+
+    return TRUE;
+}
+
+static int (*const read_mode[MODES])(fetch_t *f, operand_t *o) =
+{
+    ReadNone,           /* Dn */
+    ReadNone,           /* An */
+    ReadNone,           /* (An) */
+    ReadNone,           /* (An)+ */
+    ReadNone,           /* -(An) */
+    ReadDisp,
+    ReadIndex,
+    ReadAbsW,
+    ReadAbsL,
+    ReadPCDisp,
+    ReadPCIndex,
+    ReadImm
+};
+
+/* Operand text, written by the handler for the form
+*/
+static char *Signed(long value, char *p)
+{
+    if (value < 0)
+    {
+        return p + OutputFormat(p, "-$%2.2x", (unsigned)-value);
+    }
+
+    return p + OutputFormat(p, "$%2.2x", (unsigned)value);
+}
+
+static char *Index(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, index_format[o->index >> 15]
+                                           [(o->index >> 11) & 1],
+                            (unsigned)(o->index >> 12) & 7);
+}
+
+static char *ShowDn(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "d%u", (unsigned)o->reg);
+}
+
+static char *ShowAn(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "a%u", (unsigned)o->reg);
+}
+
+static char *ShowInd(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "(a%u)", (unsigned)o->reg);
+}
+
+static char *ShowPost(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "(a%u)+", (unsigned)o->reg);
+}
+
+static char *ShowPre(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "-(a%u)", (unsigned)o->reg);
+}
+
+static char *ShowDisp(const operand_t *o, char *p)
+{
+    p = Signed(o->disp, p);
+
+    return p + OutputFormat(p, "(a%u)", (unsigned)o->reg);
+}
+
+static char *ShowIndex(const operand_t *o, char *p)
+{
+    p = Signed(o->disp, p);
+    p += OutputFormat(p, "(a%u,", (unsigned)o->reg);
+
+    return Index(o, p);
+}
+
+static char *ShowAbsW(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "$%4.4x.w", (unsigned)o->value);
+}
+
+static char *ShowAbsL(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "$%6.6x", (unsigned)o->value);
+}
+
+static char *ShowPCDisp(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "$%6.6x(pc)", (unsigned)o->value);
+}
+
+static char *ShowPCIndex(const operand_t *o, char *p)
+{
+    p += OutputFormat(p, "$%6.6x(pc,", (unsigned)o->value);
+
+    return Index(o, p);
+}
+
+static char *ShowImm(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, imm_format[o->size], (unsigned)o->value);
+}
+
+static char *ShowQuick(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "#%u", (unsigned)o->value);
+}
+
+static char *ShowMoveq(const operand_t *o, char *p)
+{
+    *p++ = '#';
+
+    return Signed(o->disp, p);
+}
+
+static char *ShowTarget(const operand_t *o, char *p)
+{
+    return p + OutputFormat(p, "$%6.6x", (unsigned)o->value);
+}
+
+/* Registers as ranges, such as d0-d3/a0/a5-a6
+*/
+static char *ShowRegList(const operand_t *o, char *p)
+{
+    static const char *const first[] = {"d%u", "a%u"};
+    static const char *const last[] = {"-d%u", "-a%u"};
+    int shown = FALSE;
+    int r = 0;
+
+    while(r < 16)
+    {
+        int end = r;
+
+        if (!(o->value >> r & 1))
+        {
+            r++;
+            continue;
+        }
+
+        while(end + 1 < 16 && (end + 1) % 8 && o->value >> (end + 1) & 1)
+        {
+            end++;
+        }
+
+        if (shown)
+        {
+            *p++ = '/';
+        }
+
+        p += OutputFormat(p, first[r / 8], (unsigned)r % 8);
+
+        if (end > r)
+        {
+            p += OutputFormat(p, last[end / 8], (unsigned)end % 8);
+        }
+
+        shown = TRUE;
+        r = end + 1;
+    }
+
+    if (!shown)
+    {
+        *p++ = '0';
+    }
+
+    return p;
+}
+
+static char *ShowCCR(const operand_t *o, char *p)
+{
+    (void)o;
+
+    return p + OutputFormat(p, "ccr");
+}
+
+static char *ShowSR(const operand_t *o, char *p)
+{
+    (void)o;
+
+    return p + OutputFormat(p, "sr");
+}
+
+static char *ShowUSP(const operand_t *o, char *p)
+{
+    (void)o;
+
+    return p + OutputFormat(p, "usp");
+}
+
+static char *(*const show_form[eFormNone])(const operand_t *o, char *p) =
+{
+    ShowDn,
+    ShowAn,
+    ShowInd,
+    ShowPost,
+    ShowPre,
+    ShowDisp,
+    ShowIndex,
+    ShowAbsW,
+    ShowAbsL,
+    ShowPCDisp,
+    ShowPCIndex,
+    ShowImm,
+    ShowQuick,
+    ShowMoveq,
+    ShowTarget,
+    ShowRegList,
+    ShowCCR,
+    ShowSR,
+    ShowUSP
+};
+
+/* Reads an operand of op from source.  A register list's mask has already
+   been read, as it always comes first.
+*/
+static int ReadOperand(fetch_t *f, int source, word op, int size,
+                       operand_t *o)
+{
+    static const byte form[] =
+    {
+        eFormNone,      /* eOpNone */
+        eFormNone,      /* eOpEA */
+        eFormNone,      /* eOpMoveEA */
+        eFormDn,        /* eOpDn */
+        eFormAn,        /* eOpAn */
+        eFormPre,       /* eOpPre */
+        eFormPost,      /* eOpPost */
+        eFormDn,        /* eOpDn0 */
+        eFormAn,        /* eOpAn0 */
+        eFormPre,       /* eOpPre0 */
+        eFormPost,      /* eOpPost0 */
+        eFormDisp,      /* eOpDisp0 */
+        eFormImm,       /* eOpImm */
+        eFormImm,       /* eOpImmB */
+        eFormImm,       /* eOpImmW */
+        eFormQuick,     /* eOpQuick */
+        eFormMoveq,     /* eOpMoveq */
+        eFormQuick,     /* eOpTrap */
+        eFormTarget,    /* eOpBranch */
+        eFormTarget,    /* eOpDbcc */
+        eFormRegList,   /* eOpRegList */
+        eFormCCR,       /* eOpCCR */
+        eFormSR,        /* eOpSR */
+        eFormUSP        /* eOpUSP */
+    };
+    ulong w;
+
+    if (source == eOpRegList)
+    {
+        return TRUE;
+    }
+
+    o->form = form[source];
+    o->size = (byte)(size ? size : 1);
+
+    switch(source)
+    {
+        case eOpEA:
+            o->form = (byte)Mode(op & 0x3f);
+            o->reg = op & 7;
+            break;
+
+        case eOpMoveEA:
+            o->form = (byte)Mode(((op >> 3) & 0x38) | ((op >> 9) & 7));
+            o->reg = (op >> 9) & 7;
+            break;
+
+        case eOpDn:
+        case eOpAn:
+        case eOpPre:
+        case eOpPost:
+            o->reg = (op >> 9) & 7;
+            break;
+
+        case eOpImmB:
+            o->size = 1;
+            break;
+
+        case eOpImmW:
+            o->size = 2;
+            break;
+
+        case eOpQuick:
+            o->value = (op >> 9) & 7 ? (op >> 9) & 7 : 8;
+            break;
+
+        case eOpMoveq:
+            o->disp = SignExtend(op, 8);
+            break;
+
+        case eOpTrap:
+            o->value = op & 0xf;
+            break;
+
+        case eOpBranch:
+            o->disp = SignExtend(op, 8);
+
+            if (!o->disp)
+            {
+                if (!Word(f, &w))
+                {
+                    return FALSE;
+                }
+
+                o->disp = SignExtend(w, 16);
+            }
+
+            o->value = (f->address + 2 + (ulong)o->disp) & ADDRESS_MASK;
+            return TRUE;
+
+        case eOpDbcc:
+            if (!Word(f, &w))
+            {
+                return FALSE;
+            }
+
+            o->value = (f->address + 2 + (ulong)SignExtend(w, 16)) &
+                                                            ADDRESS_MASK;
+            return TRUE;
+
+        default:
+            o->reg = op & 7;
+            break;
+    }
+
+    return o->form < MODES ? read_mode[o->form](f, o) : TRUE;
+}
+
+/* Decodes the instruction at data, returning its length or zero if it is
+   incomplete
+*/
+static int Decode(const byte *data, ulong size, word address, inst_t *in)
+{
+    fetch_t f;
+    const pattern_t *p;
+    ulong op;
+
+    f.data = data;
+    f.size = size;
+    f.address = address;
+    f.pos = 0;
+
+    if (!Word(&f, &op))
+    {
+        return 0;
+    }
+
+    in->op = (word)op;
+    in->pattern = p = optable[op] ? patterns + optable[op] - 1 : NULL;
+    in->src.form = eFormNone;
+    in->dst.form = eFormNone;
+
+    if (!p)
+    {
+        in->size = 0;
+        return f.pos;
+    }
+
+    in->size = Size(p->size, in->op);
+
+    if (p->src == eOpRegList || p->dst == eOpRegList)
+    {
+        operand_t *o = p->src == eOpRegList ? &in->src : &in->dst;
+        ulong mask;
+
+        if (!Word(&f, &mask))
+        {
+            return 0;
+        }
+
+        /* A predecrement mask runs from a7 down to d0
+        */
+        if (OperandMode(p->dst, in->op) == eFormPre)
+        {
+            ulong r = 0;
+            int n;
+
+            for(n = 0; n < 16; n++)
+            {
+                r |= (mask >> n & 1) << (15 - n);
+            }
+
+            mask = r;
+        }
+
+        o->form = eFormRegList;
+        o->value = mask;
+    }
+
+    if (!ReadOperand(&f, p->src, in->op, in->size, &in->src) ||
+        !ReadOperand(&f, p->dst, in->op, in->size, &in->dst))
+    {
+        return 0;
+    }
+
+    return f.pos;
+}
+
+/* The static target of a jump or call through an effective address
+*/
+static int JumpTarget(const operand_t *o, ulong *target)
+{
+    switch(o->form)
+    {
+        case eFormAbsW:
+            *target = (ulong)SignExtend(o->value, 16) & ADDRESS_MASK;
+            return TRUE;
+
+        case eFormAbsL:
+            *target = o->value & ADDRESS_MASK;
+            return TRUE;
+
+        case eFormPCDisp:
+            *target = o->value;
+            return TRUE;
+
+        default:
+            return FALSE;
+    }
+}
+
+static void Show(const inst_t *in, char *p)
+{
+    const pattern_t *pt = in->pattern;
+
+    if (!pt)
+    {
+        p += OutputFormat(p, "dc.w $%4.4x", (unsigned)in->op);
+        *p = 0;
+        return;
+    }
+
+    p += OutputFormat(p, "%s", pt->name);
+
+    if (in->size)
+    {
+        p += OutputFormat(p, suffix_format[in->size]);
+    }
+
+    if (in->src.form != eFormNone)
+    {
+        *p++ = ' ';
+        p = show_form[in->src.form](&in->src, p);
+    }
+
+    if (in->dst.form != eFormNone)
+    {
+        *p++ = ',';
+        p = show_form[in->dst.form](&in->dst, p);
+    }
+
+    *p = 0;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void M68K_Init(void)
+{
+    int n;
+
+    for(n = 0; patterns[n].name; n++)
+    {
+        const pattern_t *p = patterns + n;
+        word free = ~p->mask & 0xffff;
+        word x = 0;
+
+        /* Every operation word the pattern matches, by counting through
+           the subsets of its free bits
+        */
+        do
+        {
+            word op = p->match | x;
+
+            if (!optable[op] && Allowed(p, op))
+            {
+                optable[op] = (byte)(n + 1);
+            }
+
+            x = (word)((x - free) & free);
+        } while(x);
+    }
+}
+
+int M68K_Decode(const byte *data, ulong size, word address,
+                decode_t *decode)
+{
+    inst_t in;
+    ulong target = 0;
+    int length;
+
+    if (!(length = Decode(data, size, address, &in)))
+    {
+        return 0;
+    }
+
+    decode->address = address;
+    decode->length = length;
+    decode->page = 0;
+    decode->opcode = in.op >> 8;
+    decode->illegal = !in.pattern || in.op == 0x4afc;
+    decode->flow = in.pattern ? in.pattern->flow : eFlowNext;
+    decode->conditional = FALSE;
+    decode->has_target = FALSE;
+    decode->target = 0;
+    decode->has_operand = FALSE;
+    decode->operand = 0;
+
+    /* No timings are kept, so this is the least any instruction takes:
+       four cycles for each word read
+    */
+    decode->cycles = length * 2;
+    decode->cycles_max = decode->cycles;
+
+    if (in.src.form == eFormTarget)
+    {
+        decode->has_target = TRUE;
+        decode->target = in.src.value;
+    }
+    else if (in.dst.form == eFormTarget)
+    {
+        decode->has_target = TRUE;
+        decode->target = in.dst.value;
+    }
+    else if (decode->flow == eFlowJump || decode->flow == eFlowCall)
+    {
+        if (JumpTarget(&in.src, &target))
+        {
+            decode->has_target = TRUE;
+            decode->target = (word)target;
+        }
+        else if (decode->flow == eFlowJump)
+        {
+            decode->flow = eFlowIndirect;
+        }
+    }
+
+    /* Code is always at even addresses
+    */
+    if (decode->has_target && decode->target & 1)
+    {
+        decode->illegal = TRUE;
+    }
+
+    if (decode->has_target)
+    {
+        decode->has_operand = TRUE;
+        decode->operand = decode->target;
+    }
+    else if (in.src.form >= eFormAbsW && in.src.form <= eFormImm &&
+             in.src.form != eFormIndex)
+    {
+        decode->has_operand = TRUE;
+        decode->operand = (word)in.src.value;
+    }
+    else if (in.dst.form >= eFormAbsW && in.dst.form <= eFormPCIndex)
+    {
+        decode->has_operand = TRUE;
+        decode->operand = (word)in.dst.value;
+    }
+
+    return length;
+}
+
+int M68K_Entries(const byte *data, ulong size, word origin,
+                 word *entry, int max)
+{
+    ulong vec;
+    int no = 0;
+
+    if (no < max)
+    {
+        entry[no++] = origin;
+    }
+
+    /* The reset vector and the autovectors if the image holds the vector
+       table
+    */
+    for(vec = 4; origin == 0 && vec < 0x80 && vec + 4 <= size && no < max;
+        vec = vec == 4 ? 0x64 : vec + 4)
+    {
+        ulong pc = (ulong)data[vec] << 24 | (ulong)data[vec + 1] << 16 |
+                   (ulong)data[vec + 2] << 8 | data[vec + 3];
+
+        if (pc)
+        {
+            entry[no++] = (word)(pc & ADDRESS_MASK);
+        }
+    }
+
+    return no;
+}
+
+word M68K_Disassemble(input_t *input, word address)
+{
+    memory_t mem = INIT_MEMORY;
+    word start_address = address;
+    char text[MAX_TEXT];
+    inst_t in;
+    int length;
+    int f;
+
+    length = Decode(input->data + input->pos, input->size - input->pos,
+                    address, &in);
+
+    if (!length)
+    {
+        /* Read past the end, as the other processors do for an instruction
+           that is cut off
+        */
+        while(!InputEOF(input))
+        {
+            GetByte(input, &address, &mem);
+        }
+
+        return start_address;
+    }
+
+    for(f = 0; f < length; f += 2)
+    {
+        GetMSBWord(input, &address, &mem);
+    }
+
+    Show(&in, text);
+    OutputLine(start_address, 6, &mem, text);
+
+    return address;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,50 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    68000 disassembly
+
+*/
+
+#ifndef DASM_M68K_H
+#define DASM_M68K_H
+
+#include "global.h"
+#include "input.h"
+#include "decode.h"
+
+/* Builds the table of operation words.  Must be called before anything
+   else here, and before any threads are started.
+*/
+void M68K_Init(void);
+
+word M68K_Disassemble(input_t *input, word address);
+int M68K_Decode(const byte *data, ulong size, word address,
+                decode_t *decode);
+int M68K_Entries(const byte *data, ulong size, word origin,
+                 word *entry, int max);
+
+extern const word M68K_Model[];
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
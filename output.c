@@ -24,52 +24,547 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 #include <stdarg.h>
+#include <ctype.h>
 
 #include "output.h"
 #include "memory.h"
+#include "template.h"
 
-static int opt[2];
+#define MAX_LINE        512
+#define MEMORY_COLUMN   42
+#define CYCLES_COLUMN   7
+
+/* The data directives of a dialect
+*/
+typedef struct
+{
+    const char  *bytes;
+    const char  *words;
+    const char  *fill;
+} directives_t;
+
+/* A recorded line.  The bytes of mem follow it, then text.  A line with
+   no address_length is text to write as it is.
+*/
+typedef struct
+{
+    word        address;
+    int         cycles;
+    int         cycles_max;
+    byte        address_length;
+    byte        mem_no;
+    short       text_len;
+} record_t;
+
+static const directives_t directives[] =
+{
+    {"db",      "dw",       "ds"},      /* eDialectDb */
+    {".byte",   ".word",    ".res"},    /* eDialectCa65 */
+    {"dc.b",    "dc.w",     "dcb.b"}    /* eDialectDevpac */
+};
+
+static int opt[eNumOutputOptions];
+static template_style_t style;
+
+static profile_t *profile;
+static int cycles = -1;
+static int cycles_max;
+static int (*word_label)(word address);
+
+static char *capture;
+static size_t capture_size;
+static size_t capture_len;
+
+static char *record;
+static size_t record_size;
+static size_t record_len;
+
+static void Write(const char *line, size_t len)
+{
+    if (capture)
+    {
+        if (capture_len + len > capture_size)
+        {
+            len = capture_size - capture_len;
+        }
+
+        memcpy(capture + capture_len, line, len);
+        capture_len += len;
+    }
+    else
+    {
+        fwrite(line, 1, len, stdout);
+    }
+}
+
+static int MemoryToHex(const memory_t *m, char *buff)
+{
+    char *p = buff;
+    int f;
+
+    for(f = 0; f < m->no; f++)
+    {
+        if (f > 0)
+        {
+            *p++ = ' ';
+        }
+
+        p += TemplateHex(m->mem[f], 2, FALSE, &style, p);
+    }
+
+    return (int)(p - buff);
+}
+
+static int CyclesColumn(int min, int max, char *buff)
+{
+    int len;
+
+    if (min == max)
+    {
+        len = sprintf(buff, "%d", min);
+    }
+    else
+    {
+        len = sprintf(buff, "%d/%d", min, max);
+    }
+
+    while(len < CYCLES_COLUMN)
+    {
+        buff[len++] = ' ';
+    }
+
+    return len;
+}
+
+static int AddressColumn(word address, int address_length, char *buff)
+{
+    char *p = buff;
+    int f;
+
+    if (opt[eShowAddress])
+    {
+        p += TemplateHex(address, address_length, FALSE, &style, p);
+
+        for(f = 0; f < 8 - address_length; f++)
+        {
+            *p++ = ' ';
+        }
+    }
+    else
+    {
+        for(f = 0; f < 8; f++)
+        {
+            *p++ = ' ';
+        }
+    }
+
+    return (int)(p - buff);
+}
+
+/* Adds the comment columns after printed characters of instruction and
+   ends the line, returning the number of characters written.  min is -1
+   if the line has no cycles.
+*/
+static int EndLine(word address, const memory_t *mem, int printed,
+                   int min, int max, char *buff)
+{
+    char *p = buff;
+    int f;
+
+    if (opt[eShowMemory] || profile || min >= 0)
+    {
+        if (printed >= MEMORY_COLUMN)
+        {
+            *p++ = ' ';
+        }
+        else
+        {
+            for(f = printed; f < MEMORY_COLUMN; f++)
+            {
+                *p++ = ' ';
+            }
+        }
+
+        *p++ = ';';
+        *p++ = ' ';
+
+        if (min >= 0)
+        {
+            p += CyclesColumn(min, max, p);
+        }
+
+        if (profile)
+        {
+            p += ProfileColumn(profile, address, mem->no, p);
+        }
+
+        if (opt[eShowMemory])
+        {
+            p += MemoryToHex(mem, p);
+        }
+        else
+        {
+            while(p[-1] == ' ')
+            {
+                p--;
+            }
+        }
+    }
+
+    *p++ = '\n';
+
+    return (int)(p - buff);
+}
+
+/* Writes a line of text after its address, followed by its comment
+   columns
+*/
+static void Compose(word address, int address_length, const memory_t *mem,
+                    const char *text, int printed, int min, int max)
+{
+    char line[MAX_LINE];
+    char *p = line;
+
+    p += AddressColumn(address, address_length, p);
+    memcpy(p, text, (size_t)printed);
+    p += printed;
+    p += EndLine(address, mem, printed, min, max, p);
+
+    Write(line, (size_t)(p - line));
+}
+
+/* Adds a line to the record.  Lines that do not fit are dropped.
+*/
+static void Record(word address, int address_length, const memory_t *mem,
+                   const char *text, int printed)
+{
+    record_t r;
+    int mem_no = mem ? mem->no : 0;
+
+    if (record_len + sizeof r + (size_t)mem_no + (size_t)printed >
+                                                            record_size)
+    {
+        return;
+    }
+
+    r.address = address;
+    r.cycles = address_length ? cycles : -1;
+    r.cycles_max = cycles_max;
+    r.address_length = (byte)address_length;
+    r.mem_no = (byte)mem_no;
+    r.text_len = (short)printed;
+
+    memcpy(record + record_len, &r, sizeof r);
+    record_len += sizeof r;
+    if (mem_no)
+    {
+        memcpy(record + record_len, mem->mem, (size_t)mem_no);
+        record_len += (size_t)mem_no;
+    }
+
+    memcpy(record + record_len, text, (size_t)printed);
+    record_len += (size_t)printed;
+}
+
+/* Outputs a line of instruction or data text with its columns
+*/
+static void Line(word address, int address_length, const memory_t *mem,
+                 const char *text, int printed)
+{
+    if (record)
+    {
+        Record(address, address_length, mem, text, printed);
+    }
+    else
+    {
+        Compose(address, address_length, mem, text, printed,
+                cycles, cycles_max);
+    }
+
+    cycles = -1;
+    style.labelled = FALSE;
+}
+
+/* Outputs a whole line of text
+*/
+static void Emit(const char *line, size_t len)
+{
+    if (record)
+    {
+        Record(0, 0, NULL, line, (int)len);
+    }
+    else
+    {
+        Write(line, len);
+    }
+}
+
+static char *Directive(const char *name, char *p)
+{
+    while(*name)
+    {
+        *p++ = style.uppercase ? (char)toupper((unsigned char)*name) : *name;
+        name++;
+    }
+
+    *p++ = ' ';
+
+    return p;
+}
 
 void Output(word address, int address_length, memory_t *mem,
             const char *format, ...)
 {
+    char text[MAX_LINE];
     va_list va;
     int printed;
 
-    if (opt[eShowAddress])
+    va_start(va, format);
+    printed = TemplateRender(TemplateFind(format), &style, va, text);
+    va_end(va);
+
+    Line(address, address_length, mem, text, printed);
+}
+
+int OutputFormat(char *buff, const char *format, ...)
+{
+    va_list va;
+    int printed;
+
+    va_start(va, format);
+    printed = TemplateRender(TemplateFind(format), &style, va, buff);
+    va_end(va);
+
+    return printed;
+}
+
+void OutputLine(word address, int address_length, memory_t *mem,
+                const char *text)
+{
+    Line(address, address_length, mem, text, (int)strlen(text));
+}
+
+void OutputData(word address, int address_length, const byte *data, int no,
+                data_format fmt)
+{
+    char text[MAX_LINE];
+    char *p = text;
+    memory_t mem = INIT_MEMORY;
+    int quoted = FALSE;
+    int f;
+
+    for(f = 0; f < no; f++)
     {
-        printf("%*.*x%*.*s", address_length, address_length, address,
-                             8 - address_length, 8 - address_length, "");
+        MemoryAddByte(&mem, data[f]);
+    }
+
+    if (fmt == eDataWordsLSB || fmt == eDataWordsMSB)
+    {
+        p = Directive(directives[opt[eDialect]].words, p);
+
+        for(f = 0; f + 1 < no; f += 2)
+        {
+            ulong w = fmt == eDataWordsLSB ? data[f] | data[f + 1] << 8
+                                           : data[f] << 8 | data[f + 1];
+
+            if (f > 0)
+            {
+                *p++ = ',';
+            }
+
+            if (word_label && word_label((word)w))
+            {
+                *p++ = 'L';
+                p += TemplateHex(w, 4, FALSE, &style, p);
+            }
+            else
+            {
+                p += TemplateHex(w, 4, TRUE, &style, p);
+            }
+        }
     }
     else
     {
-        printf("%8.8s", "");
+        p = Directive(directives[opt[eDialect]].bytes, p);
+
+        for(f = 0; f < no; f++)
+        {
+            int text = fmt == eDataText && data[f] >= 0x20 &&
+                       data[f] < 0x7f && data[f] != '"';
+
+            if (text && quoted)
+            {
+                *p++ = (char)data[f];
+                continue;
+            }
+
+            if (quoted)
+            {
+                *p++ = '"';
+                quoted = FALSE;
+            }
+
+            if (f > 0)
+            {
+                *p++ = ',';
+            }
+
+            if (text)
+            {
+                *p++ = '"';
+                *p++ = (char)data[f];
+                quoted = TRUE;
+            }
+            else
+            {
+                p += TemplateHex(data[f], 2, TRUE, &style, p);
+            }
+        }
+
+        if (quoted)
+        {
+            *p++ = '"';
+        }
+    }
+
+    Line(address, address_length, &mem, text, (int)(p - text));
+}
+
+void OutputFill(word address, int address_length, memory_t *mem,
+                ulong count, byte value)
+{
+    char text[MAX_LINE];
+    char *p = Directive(directives[opt[eDialect]].fill, text);
+
+    p += sprintf(p, "%lu,", count);
+    p += TemplateHex(value, 2, TRUE, &style, p);
+
+    Line(address, address_length, mem, text, (int)(p - text));
+}
+
+void OutputComment(const char *format, ...)
+{
+    char line[MAX_LINE];
+    char *p = line;
+    va_list va;
+    int f;
+
+    for(f = 0; f < 8; f++)
+    {
+        *p++ = ' ';
     }
 
+    *p++ = ';';
+    *p++ = ' ';
+
     va_start(va, format);
-    printed = vprintf(format, va);
+    p += TemplateRender(TemplateFind(format), &style, va, p);
     va_end(va);
 
-    if (opt[eShowMemory])
+    *p++ = '\n';
+
+    Emit(line, (size_t)(p - line));
+}
+
+void OutputCapture(char *buff, size_t size)
+{
+    capture = buff;
+    capture_size = size;
+    capture_len = 0;
+}
+
+size_t OutputCaptured(void)
+{
+    return capture_len;
+}
+
+void OutputRecord(char *buff, size_t size)
+{
+    record = buff;
+    record_size = size;
+    record_len = 0;
+}
+
+size_t OutputRecorded(void)
+{
+    return record_len;
+}
+
+size_t OutputReplay(const char *buff, size_t len)
+{
+    size_t pos = 0;
+
+    while(pos < len && (!capture || capture_len + MAX_LINE <= capture_size))
     {
-        if (printed >= 42)
+        memory_t mem = INIT_MEMORY;
+        const char *text;
+        record_t r;
+
+        memcpy(&r, buff + pos, sizeof r);
+        pos += sizeof r;
+        memcpy(mem.mem, buff + pos, r.mem_no);
+        mem.no = r.mem_no;
+        pos += r.mem_no;
+        text = buff + pos;
+        pos += (size_t)r.text_len;
+
+        if (r.address_length)
         {
-            printf(" ; %s", MemoryToString(mem));
+            Compose(r.address, r.address_length, &mem, text, r.text_len,
+                    r.cycles, r.cycles_max);
         }
         else
         {
-            printf("%*.*s; %s", 42 - printed, 42 - printed, "",
-                                MemoryToString(mem));
+            Write(text, (size_t)r.text_len);
         }
     }
 
-    printf("\n");
+    return pos;
+}
+
+void OutputCycles(int min, int max)
+{
+    cycles = min;
+    cycles_max = max;
+}
+
+void OutputTarget(word target)
+{
+    style.labelled = TRUE;
+    style.label = target;
+}
+
+void OutputLabel(word address)
+{
+    char line[MAX_LINE];
+    char *p = line;
+
+    *p++ = 'L';
+    p += TemplateHex(address, 4, FALSE, &style, p);
+    *p++ = ':';
+    *p++ = '\n';
+
+    Emit(line, (size_t)(p - line));
+}
+
+void OutputWordLabels(int (*is_label)(word address))
+{
+    word_label = is_label;
+}
+
+void OutputProfile(profile_t *p)
+{
+    profile = p;
 }
 
 void OutputOption(output_option option, int setting)
 {
     opt[option] = setting;
+
+    style.uppercase = opt[eUppercase];
+    style.hex_style = (hex_style_t)opt[eHexStyle];
 }
 
 /*
@@ -26,18 +26,112 @@
 #ifndef DASM_OUTPUT_H
 #define DASM_OUTPUT_H
 
+#include <stddef.h>
 #include "global.h"
 #include "memory.h"
+#include "profile.h"
 
 typedef enum
 {
     eShowAddress,
     eShowMemory,
+    eUppercase,
+    eHexStyle,          /* One of the hex_style_t values in template.h */
+    eDialect,           /* One of the dialect_t values */
+    eNumOutputOptions
 } output_option;
 
+/* The assembler dialects, which differ in their data directives
+*/
+typedef enum
+{
+    eDialectDb,         /* db, dw and ds */
+    eDialectCa65,       /* .byte, .word and .res */
+    eDialectDevpac      /* dc.b, dc.w and dcb.b */
+} dialect_t;
+
 void Output(word address, int address_length, memory_t *mem,
             const char *format, ...);
 
+/* For decoders that build an instruction in pieces: OutputFormat() renders
+   format to buff as Output() would, returning the number of characters
+   written, and OutputLine() outputs the finished text as it is.
+*/
+int OutputFormat(char *buff, const char *format, ...);
+void OutputLine(word address, int address_length, memory_t *mem,
+                const char *text);
+
+typedef enum
+{
+    eDataBytes,         /* db $01,$02 */
+    eDataWordsLSB,      /* dw $0201 */
+    eDataWordsMSB,      /* dw $0102 */
+    eDataText           /* db "Text",$0d */
+} data_format;
+
+/* Outputs no bytes of data as a single db or dw line, written directly
+   rather than through a template.  Words need an even number of bytes.
+*/
+void OutputData(word address, int address_length, const byte *data, int no,
+                data_format fmt);
+
+/* Outputs a line reserving count bytes of value, whose single byte is mem
+*/
+void OutputFill(word address, int address_length, memory_t *mem,
+                ulong count, byte value);
+
+/* Outputs a comment line.  The format takes the same conversions as Output(),
+   and %#s for a string such as a file name that is written as it is rather
+   than in the case of the listing.
+*/
+void OutputComment(const char *format, ...);
+
+/* Sends output to buff rather than stdout until called again with a NULL
+   buffer.  Output that does not fit is dropped.  OutputCaptured() returns
+   the number of characters written to the buffer so far.
+*/
+void OutputCapture(char *buff, size_t size);
+size_t OutputCaptured(void);
+
+/* Records the lines output to buff rather than writing them, until called
+   again with a NULL buffer, so that another thread can lay them out with
+   OutputReplay().  The instruction text is rendered as it is recorded and
+   the address, cycles and memory columns as it is replayed.  Lines that do
+   not fit are dropped.  OutputRecorded() returns the size of the record so
+   far.
+*/
+void OutputRecord(char *buff, size_t size);
+size_t OutputRecorded(void);
+
+/* Outputs the lines of a record of len bytes, stopping early if output is
+   being captured and the next line may not fit.  Returns the number of
+   bytes of the record used.
+*/
+size_t OutputReplay(const char *buff, size_t len);
+
+/* Adds the cycles an instruction takes to the next line output.  max is
+   shown as well if it differs.
+*/
+void OutputCycles(int min, int max);
+
+/* Shows the hex address target as a label in the next line output
+*/
+void OutputTarget(word target);
+
+/* Outputs the label line for address
+*/
+void OutputLabel(word address);
+
+/* Shows each word of a dw that is_label returns TRUE for as a label, or
+   none if is_label is NULL
+*/
+void OutputWordLabels(int (*is_label)(word address));
+
+/* Adds a column of execution counts from p to each line, or removes it if
+   p is NULL.
+*/
+void OutputProfile(profile_t *p);
+
 void OutputOption(output_option opt, int setting);
 
 #endif
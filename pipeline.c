@@ -0,0 +1,318 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Pipelined listing.
+
+    The lines are rendered on a thread of their own and recorded with
+    OutputRecord() into blocks, which the calling thread lays out into
+    blocks of output with OutputReplay() for a third thread to write.  Each
+    set of blocks is a single-producer, single-consumer ring with a head
+    only its producer writes and a tail only its consumer writes, so passing
+    a block takes an acquire load of the other side's index and a release
+    store of its own.  A side that finds its ring full or empty sleeps on
+    the ring's condition variable until the other side moves its index.  A
+    block with the end flag set ends the stream.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__unix__) || defined(__APPLE__)) && \
+    defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#define USE_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+#include "pipeline.h"
+#include "output.h"
+
+#ifdef USE_THREADS
+
+#define BLOCKS          8               /* Must be a power of 2 */
+#define BLOCK_SIZE      0x10000
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    atomic_size_t       head;
+    char                pad[64];        /* Keeps the indexes apart in cache */
+    atomic_size_t       tail;
+    pthread_mutex_t     lock;
+    pthread_cond_t      moved;
+} ring_t;
+
+typedef struct
+{
+    ring_t      ring;
+    char        data[BLOCKS][BLOCK_SIZE];
+    size_t      len[BLOCKS];
+    int         end[BLOCKS];
+} blocks_t;
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static blocks_t lines;
+static blocks_t output;
+
+static pipe_line_t list_line;
+static void *list_ctx;
+
+
+/* ---------------------------------------- UTILS
+*/
+static void RingInit(ring_t *r)
+{
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->moved, NULL);
+}
+
+static void RingFree(ring_t *r)
+{
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->moved);
+}
+
+/* Wakes the other side after an index has moved.  Taking the lock means a
+   side that has just found the ring full or empty is either still to look
+   again or already waiting.
+*/
+static void Moved(ring_t *r)
+{
+    pthread_mutex_lock(&r->lock);
+    pthread_cond_signal(&r->moved);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static int Full(ring_t *r)
+{
+    return atomic_load_explicit(&r->head, memory_order_relaxed) -
+           atomic_load_explicit(&r->tail, memory_order_acquire) == BLOCKS;
+}
+
+static int Empty(ring_t *r)
+{
+    return atomic_load_explicit(&r->head, memory_order_acquire) ==
+           atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+/* Waits for a free block, returning its index
+*/
+static size_t Reserve(ring_t *r)
+{
+    if (Full(r))
+    {
+        pthread_mutex_lock(&r->lock);
+
+        while(Full(r))
+        {
+            pthread_cond_wait(&r->moved, &r->lock);
+        }
+
+        pthread_mutex_unlock(&r->lock);
+    }
+
+    return atomic_load_explicit(&r->head, memory_order_relaxed) &
+                                                            (BLOCKS - 1);
+}
+
+static void Publish(ring_t *r)
+{
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    Moved(r);
+}
+
+/* Waits for a filled block, returning its index
+*/
+static size_t Acquire(ring_t *r)
+{
+    if (Empty(r))
+    {
+        pthread_mutex_lock(&r->lock);
+
+        while(Empty(r))
+        {
+            pthread_cond_wait(&r->moved, &r->lock);
+        }
+
+        pthread_mutex_unlock(&r->lock);
+    }
+
+    return atomic_load_explicit(&r->tail, memory_order_relaxed) &
+                                                            (BLOCKS - 1);
+}
+
+static void Release(ring_t *r)
+{
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+    Moved(r);
+}
+
+static void *Renderer(void *arg)
+{
+    int more = TRUE;
+    size_t b;
+
+    (void)arg;
+
+    while(more)
+    {
+        b = Reserve(&lines.ring);
+
+        OutputRecord(lines.data[b], BLOCK_SIZE);
+
+        while(more && OutputRecorded() <= BLOCK_SIZE - PIPE_MAX_OUTPUT)
+        {
+            more = list_line(list_ctx);
+        }
+
+        lines.len[b] = OutputRecorded();
+        lines.end[b] = !more;
+        OutputRecord(NULL, 0);
+
+        Publish(&lines.ring);
+    }
+
+    return NULL;
+}
+
+static void *Writer(void *arg)
+{
+    size_t n;
+
+    (void)arg;
+
+    for(;;)
+    {
+        n = Acquire(&output.ring);
+
+        if (output.end[n])
+        {
+            break;
+        }
+
+        fwrite(output.data[n], 1, output.len[n], stdout);
+        Release(&output.ring);
+    }
+
+    Release(&output.ring);
+
+    return NULL;
+}
+
+#endif
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int Pipeline(pipe_line_t line, void *ctx)
+{
+#ifdef USE_THREADS
+    pthread_t renderer;
+    pthread_t writer;
+    size_t b;
+    int end = FALSE;
+
+    list_line = line;
+    list_ctx = ctx;
+
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+    {
+        return FALSE;
+    }
+
+    RingInit(&lines.ring);
+    RingInit(&output.ring);
+
+    if (pthread_create(&renderer, NULL, Renderer, NULL) != 0)
+    {
+        RingFree(&lines.ring);
+        RingFree(&output.ring);
+        return FALSE;
+    }
+
+    if (pthread_create(&writer, NULL, Writer, NULL) != 0)
+    {
+        fprintf(stderr, "dasm: cannot start the writer thread\n");
+        exit(EXIT_FAILURE);
+    }
+
+    while(!end)
+    {
+        size_t n = Acquire(&lines.ring);
+        size_t pos = 0;
+
+        end = lines.end[n];
+
+        do
+        {
+            b = Reserve(&output.ring);
+
+            OutputCapture(output.data[b], BLOCK_SIZE);
+            pos += OutputReplay(lines.data[n] + pos, lines.len[n] - pos);
+            output.len[b] = OutputCaptured();
+            output.end[b] = FALSE;
+            OutputCapture(NULL, 0);
+
+            if (output.len[b])
+            {
+                Publish(&output.ring);
+            }
+        } while(pos < lines.len[n]);
+
+        Release(&lines.ring);
+    }
+
+    b = Reserve(&output.ring);
+    output.end[b] = TRUE;
+    Publish(&output.ring);
+
+    pthread_join(renderer, NULL);
+    pthread_join(writer, NULL);
+
+    RingFree(&lines.ring);
+    RingFree(&output.ring);
+
+    return TRUE;
+#else
+    (void)line;
+    (void)ctx;
+
+    return FALSE;
+#endif
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,55 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Pipelined listing.
+
+*/
+
+#ifndef DASM_PIPELINE_H
+#define DASM_PIPELINE_H
+
+#include "global.h"
+
+/* Most output a single line may record
+*/
+#define PIPE_MAX_OUTPUT 0x4000
+
+/* Outputs the next line of the listing through the output module,
+   returning FALSE at the end of the listing
+*/
+typedef int     (*pipe_line_t)(void *ctx);
+
+/* Lists the lines from line.  line runs on a thread of its own with its
+   output recorded, the layout of the recorded lines on the calling thread
+   and the writing of the laid out blocks on a third, so that the decoding
+   and rendering of instructions, the address, cycle and memory columns
+   and the writes all overlap and output comes out in the order of the
+   lines.  Returns FALSE without doing anything if threads are not
+   available or only one processor is online, as the stages would then
+   only take turns.
+*/
+int Pipeline(pipe_line_t line, void *ctx);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
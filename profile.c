@@ -0,0 +1,378 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Execution profiles.
+
+    Counts files and PC traces are both folded into one counter per address
+    in a single pass, so a trace of any length costs only the 64K array.
+    While the listing is written, instructions that ran are gathered into
+    ranges of adjacent executed code for the summary at the end.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "profile.h"
+#include "output.h"
+#include "util.h"
+
+
+/* ---------------------------------------- UTILS
+*/
+/* Parses one line, returning FALSE if it does not start with an address.
+   Blank lines set a count of zero.
+*/
+static int ParseLine(const byte *p, const byte *eol, word *address,
+                     ulong *count)
+{
+    const byte *s;
+    int digits = 0;
+
+    *address = 0;
+    *count = 0;
+
+    p = SkipSpace(p, eol);
+
+    if (p == eol)
+    {
+        return TRUE;
+    }
+
+    while(p < eol && hex_value[*p] >= 0)
+    {
+        *address = *address << 4 | (word)hex_value[*p++];
+        digits++;
+    }
+
+    if (digits == 0 || digits > 8)
+    {
+        return FALSE;
+    }
+
+    *count = 1;
+
+    if (p < eol && *p == ':')
+    {
+        return TRUE;
+    }
+
+    s = SkipSpace(p, eol);
+
+    if (s == eol || s == p)
+    {
+        return s == eol;
+    }
+
+    for(*count = 0, p = s; p < eol && *p >= '0' && *p <= '9'; p++)
+    {
+        *count = *count * 10 + (ulong)(*p - '0');
+    }
+
+    return SkipSpace(p, eol) == eol;
+}
+
+static int CompareEntry(const void *a, const void *b)
+{
+    const profile_entry_t *ea = a;
+    const profile_entry_t *eb = b;
+
+    if (ea->address != eb->address)
+    {
+        return ea->address < eb->address ? -1 : 1;
+    }
+
+    return 0;
+}
+
+/* Returns the index of the first entry at or above address
+*/
+static ulong LowerBound(const profile_t *p, word address)
+{
+    ulong lo = 0;
+    ulong hi = p->entries;
+
+    while(lo < hi)
+    {
+        ulong mid = lo + (hi - lo) / 2;
+
+        if (p->entry[mid].address < address)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* Returns the entry for address, or NULL if it was never executed
+*/
+static const profile_entry_t *Find(const profile_t *p, word address)
+{
+    ulong n = LowerBound(p, address);
+
+    if (n < p->entries && p->entry[n].address == address)
+    {
+        return p->entry + n;
+    }
+
+    return NULL;
+}
+
+static double Weight(const profile_t *p, const profile_entry_t *e)
+{
+    if (p->weighed)
+    {
+        return (double)e->count * e->cycles;
+    }
+
+    return (double)e->count;
+}
+
+static int CompareRange(const void *a, const void *b)
+{
+    const hot_range_t *ra = a;
+    const hot_range_t *rb = b;
+
+    if (ra->weight != rb->weight)
+    {
+        return ra->weight > rb->weight ? -1 : 1;
+    }
+
+    return ra->start < rb->start ? -1 : 1;
+}
+
+static int Percent(double weight, double total, char *buff)
+{
+    return sprintf(buff, "%6.2f%%", total > 0 ? weight * 100.0 / total : 0.0);
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+profile_t *ProfileLoad(const char *path)
+{
+    image_t img;
+    profile_t *prof;
+    const byte *p;
+    const byte *end;
+    ulong line_no = 1;
+    ulong alloc = 0;
+    ulong n;
+
+    if (!ImageOpen(&img, path))
+    {
+        fprintf(stderr, "dasm: cannot read profile %s\n", path);
+        return NULL;
+    }
+
+    if (!(prof = calloc(1, sizeof *prof)))
+    {
+        fprintf(stderr, "dasm: out of memory\n");
+        ImageClose(&img);
+        return NULL;
+    }
+
+
+    p = img.file;
+    end = p + img.file_size;
+
+    while(p < end)
+    {
+        const byte *eol = memchr(p, '\n', (size_t)(end - p));
+        word address;
+        ulong count;
+
+        if (!eol)
+        {
+            eol = end;
+        }
+
+        if (!ParseLine(p, eol, &address, &count))
+        {
+            fprintf(stderr, "dasm: bad profile %s: line %lu\n",
+                            path, line_no);
+            ImageClose(&img);
+            ProfileFree(prof);
+            return NULL;
+        }
+
+        if (count)
+        {
+            if (prof->entries == alloc)
+            {
+                alloc = alloc ? alloc * 2 : 1024;
+                prof->entry = Alloc(prof->entry, sizeof *prof->entry * alloc);
+            }
+
+            prof->entry[prof->entries].address = address;
+            prof->entry[prof->entries].count = count;
+            prof->entry[prof->entries].cycles = 0;
+            prof->entries++;
+            prof->total += (double)count;
+        }
+
+        p = eol + 1;
+        line_no++;
+    }
+
+    ImageClose(&img);
+
+    /* Sort the counts by address and add up those of the same address
+    */
+    qsort(prof->entry, prof->entries, sizeof *prof->entry, CompareEntry);
+
+    for(n = 0, alloc = 0; n < prof->entries; n++)
+    {
+        if (alloc && prof->entry[alloc - 1].address == prof->entry[n].address)
+        {
+            prof->entry[alloc - 1].count += prof->entry[n].count;
+        }
+        else
+        {
+            prof->entry[alloc++] = prof->entry[n];
+        }
+    }
+
+    prof->entries = alloc;
+
+    return prof;
+}
+
+void ProfileFree(profile_t *p)
+{
+    if (p)
+    {
+        free(p->entry);
+        free(p->range);
+        free(p);
+    }
+}
+
+void ProfileWeigh(profile_t *p, const CPU *cpu, const image_t *img)
+{
+    int n;
+    ulong f;
+
+    p->weighed = TRUE;
+    p->total = 0;
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+
+        for(f = LowerBound(p, seg->address);
+            f < p->entries && p->entry[f].address - seg->address < seg->size;
+            f++)
+        {
+            profile_entry_t *e = p->entry + f;
+            ulong off = e->address - seg->address;
+            decode_t d;
+
+            if (cpu->decode(seg->data + off, seg->size - off, e->address, &d))
+            {
+                e->cycles = (byte)d.cycles;
+            }
+        }
+    }
+
+    for(f = 0; f < p->entries; f++)
+    {
+        p->total += Weight(p, p->entry + f);
+    }
+}
+
+int ProfileColumn(profile_t *p, word address, int length, char *buff)
+{
+    const profile_entry_t *e = Find(p, address);
+    hot_range_t *r;
+    int len;
+
+    if (!e)
+    {
+        p->open = FALSE;
+        memset(buff, ' ', PROFILE_COLUMN);
+        return PROFILE_COLUMN;
+    }
+
+    r = p->no ? p->range + p->no - 1 : NULL;
+
+    if (!p->open || !r || r->end + 1 != address)
+    {
+        if (p->no == p->alloc)
+        {
+            p->alloc = p->alloc ? p->alloc * 2 : 64;
+            p->range = Alloc(p->range, sizeof *p->range * p->alloc);
+        }
+
+        r = p->range + p->no++;
+        r->start = address;
+        r->weight = 0;
+        p->open = TRUE;
+    }
+
+    r->end = address + (length > 0 ? length - 1 : 0);
+    r->weight += Weight(p, e);
+
+    len = sprintf(buff, "%11lu ", e->count);
+    len += Percent(Weight(p, e), p->total, buff + len);
+
+    while(len < PROFILE_COLUMN)
+    {
+        buff[len++] = ' ';
+    }
+
+    return len;
+}
+
+void ProfileSummary(profile_t *p, int max)
+{
+    int f;
+
+    qsort(p->range, p->no, sizeof *p->range, CompareRange);
+
+    OutputComment("hottest ranges:");
+
+    for(f = 0; f < p->no && f < max; f++)
+    {
+        const hot_range_t *r = p->range + f;
+        char count[32];
+        char pct[16];
+
+        sprintf(count, "%.0f", r->weight);
+        Percent(r->weight, p->total, pct);
+
+        OutputComment("  $%4.4x-$%4.4x %s %s %s", r->start, r->end,
+                      pct, count, p->weighed ? "cycles" : "steps");
+    }
+
+    p->no = 0;
+    p->open = FALSE;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
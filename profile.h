@@ -0,0 +1,96 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Execution profiles.
+
+*/
+
+#ifndef DASM_PROFILE_H
+#define DASM_PROFILE_H
+
+#include "global.h"
+#include "decode.h"
+#include "image.h"
+
+#define PROFILE_COLUMN  20
+
+/* The execution count of one address
+*/
+typedef struct
+{
+    word        address;
+    ulong       count;
+    byte        cycles;
+} profile_entry_t;
+
+/* A contiguous run of executed instructions in the listing
+*/
+typedef struct
+{
+    word        start;
+    word        end;
+    double      weight;
+} hot_range_t;
+
+typedef struct
+{
+    profile_entry_t *entry;     /* Sorted by address */
+    ulong       entries;
+    int         weighed;        /* Weighted by cycles rather than steps */
+    double      total;
+
+    hot_range_t *range;
+    int         no;
+    int         alloc;
+    int         open;           /* The last range is still growing */
+} profile_t;
+
+/* Reads a profile into a table of execution counts by address.  Each line
+   of the file is either "address count" or a single address of up to 32
+   bits, optionally followed by a colon and anything else, counted as one
+   step of a PC trace.  Returns NULL after reporting an error.
+*/
+profile_t *ProfileLoad(const char *path);
+
+void ProfileFree(profile_t *p);
+
+/* Weights each executed instruction in the image by its cycles, so that
+   percentages become a share of the time spent rather than of the steps.
+   Addresses outside the image are left out of the total.
+*/
+void ProfileWeigh(profile_t *p, const CPU *cpu, const image_t *img);
+
+/* Writes the profile column for the instruction of length bytes at address
+   to buff, returning the number of characters written.  Instructions are
+   expected in listing order so that runs of executed code can be collected
+   for ProfileSummary().
+*/
+int ProfileColumn(profile_t *p, word address, int length, char *buff);
+
+/* Outputs the max hottest ranges as comments.
+*/
+void ProfileSummary(profile_t *p, int max);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
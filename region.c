@@ -0,0 +1,586 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Regions of an image that are not disassembled as code.
+
+    Runs of fill bytes are found a machine word at a time: the byte that
+    starts a run is copied into every byte of a word, and whole words of
+    the image are compared against it until one differs.
+
+    Text is found by looking up each byte's class in a table.  Only every
+    min_run'th byte is looked at until one is a character, as no run long
+    enough can miss it, so most data and code is passed over without
+    touching the bytes in between.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "region.h"
+#include "image.h"
+#include "util.h"
+
+/* A ulong with every byte set to one
+*/
+#define ONES            ((ulong)-1 / 0xff)
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static const struct
+{
+    const char          *name;
+    region_type_t       type;
+} type_table[] =
+{
+    {"code",    eRegionCode},
+    {"byte",    eRegionByte},
+    {"word",    eRegionWord},
+    {"text",    eRegionText},
+    {"skip",    eRegionSkip},
+    {"table",   eRegionTable},
+    {NULL}
+};
+
+static const struct
+{
+    const char          *name;
+    charset_t           charset;
+} charset_table[] =
+{
+    {"ascii",   eCharsetASCII},
+    {"petscii", eCharsetPETSCII},
+    {"zx",      eCharsetZX},
+    {NULL}
+};
+
+/* Classes of characters for RegionFindText()
+*/
+#define NOT_TEXT        0
+#define SYMBOL          1
+#define LETTER          2
+
+
+/* ---------------------------------------- UTILS
+*/
+static void BuildClasses(charset_t charset, byte *class)
+{
+    int c;
+
+    memset(class, NOT_TEXT, 256);
+
+    for(c = 0x20; c < 0x80; c++)
+    {
+        class[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                   c == ' ' ? LETTER : SYMBOL;
+    }
+
+    class[0x0d] = SYMBOL;
+
+    switch(charset)
+    {
+        case eCharsetASCII:
+            class[0x09] = SYMBOL;
+            class[0x0a] = SYMBOL;
+            class[0x7f] = NOT_TEXT;
+            break;
+
+        /* Lower case letters are where ASCII has upper case, and upper
+           case are 0xc1-0xda
+        */
+        case eCharsetPETSCII:
+            for(c = 0x60; c < 0x80; c++)
+            {
+                class[c] = NOT_TEXT;
+            }
+
+            for(c = 0xc1; c <= 0xda; c++)
+            {
+                class[c] = LETTER;
+            }
+            break;
+
+        /* As ASCII but with pound at 0x60 and copyright at 0x7f
+        */
+        case eCharsetZX:
+            break;
+    }
+}
+
+/* Finds the text in data from pos up to end
+*/
+static void FindText(region_list_t *list, const byte *data, ulong pos,
+                     ulong end, word address, const byte *class,
+                     ulong min_run, int bit7)
+{
+    while(pos + min_run <= end)
+    {
+        ulong start = pos + min_run - 1;
+        ulong stop = pos + min_run;
+        ulong letters = 0;
+        int ended = FALSE;
+        ulong f;
+
+        if (!class[data[start]])
+        {
+            pos += min_run;
+            continue;
+        }
+
+        /* The byte before pos is never text, so the run starts after it
+        */
+        while(start > pos && class[data[start - 1]])
+        {
+            start--;
+        }
+
+        while(stop < end && class[data[stop]])
+        {
+            stop++;
+        }
+
+        if (bit7 && stop < end && data[stop] & 0x80 &&
+            class[data[stop] & 0x7f])
+        {
+            stop++;
+            ended = TRUE;
+        }
+
+        for(f = start; f < stop; f++)
+        {
+            letters += class[data[f] & (ended ? 0x7f : 0xff)] == LETTER;
+        }
+
+        if (stop - start >= min_run && letters * 4 >= (stop - start) * 3)
+        {
+            RegionAdd(list, address + start, address + stop - 1,
+                      eRegionText, 0);
+        }
+
+        pos = ended ? stop : stop + 1;
+    }
+}
+
+static ulong RunLength(const byte *p, ulong size)
+{
+    ulong pattern = ONES * p[0];
+    ulong n = 1;
+
+    while(n + sizeof pattern <= size)
+    {
+        ulong w;
+
+        memcpy(&w, p + n, sizeof w);
+
+        if (w != pattern)
+        {
+            break;
+        }
+
+        n += sizeof w;
+    }
+
+    while(n < size && p[n] == p[0])
+    {
+        n++;
+    }
+
+    return n;
+}
+
+
+/* Reads a hex address of up to 32 bits with an optional $ or 0x prefix,
+   returning NULL if there is none.  Maps may be read before the CPU is
+   known, so any address an image can hold is taken.
+*/
+static const byte *ReadAddress(const byte *p, const byte *end, word *address)
+{
+    const byte *start;
+    ulong value = 0;
+
+    if (p < end && *p == '$')
+    {
+        p++;
+    }
+    else if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+        p += 2;
+    }
+
+    for(start = p; p < end && hex_value[*p] >= 0; p++)
+    {
+        value = value << 4 | (ulong)hex_value[*p];
+    }
+
+    if (p == start || p - start > 8)
+    {
+        return NULL;
+    }
+
+    *address = (word)value;
+
+    return p;
+}
+
+/* Parses one line of a map file, returning an error or NULL if it was
+   fine.
+*/
+static const char *ParseLine(region_list_t *list, const byte *p,
+                             const byte *end)
+{
+    word start;
+    word finish;
+    const byte *name;
+    int f;
+
+    p = SkipSpace(p, end);
+
+    if (p == end || *p == ';' || *p == '#')
+    {
+        return NULL;
+    }
+
+    if (!(p = ReadAddress(p, end, &start)))
+    {
+        return "bad start address";
+    }
+
+    p = SkipSpace(p, end);
+
+    if (p < end && *p == '-')
+    {
+        p = SkipSpace(p + 1, end);
+    }
+
+    if (!(p = ReadAddress(p, end, &finish)) || finish < start)
+    {
+        return "bad end address";
+    }
+
+    name = p = SkipSpace(p, end);
+
+    while(p < end && *p != ' ' && *p != '\t' && *p != '\r' &&
+          *p != ';' && *p != '#')
+    {
+        p++;
+    }
+
+    for(f = 0; type_table[f].name; f++)
+    {
+        if (strlen(type_table[f].name) == (size_t)(p - name) &&
+            !strncmp(type_table[f].name, (const char *)name,
+                     (size_t)(p - name)))
+        {
+            break;
+        }
+    }
+
+    if (!type_table[f].name)
+    {
+        return "unknown region type";
+    }
+
+    p = SkipSpace(p, end);
+
+    if (p < end && *p != ';' && *p != '#')
+    {
+        return "unexpected text after the type";
+    }
+
+    RegionAdd(list, start, finish, type_table[f].type, 0);
+
+    return NULL;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void RegionAdd(region_list_t *list, word start, word end,
+               region_type_t type, byte value)
+{
+    int n = list->no;
+
+    if (list->no == list->alloc)
+    {
+        list->alloc = list->alloc ? list->alloc * 2 : 64;
+        list->region = Alloc(list->region,
+                             sizeof *list->region * list->alloc);
+    }
+
+    /* Regions nearly always arrive in order, so this rarely moves any
+    */
+    while(n > 0 && list->region[n - 1].start > start)
+    {
+        n--;
+    }
+
+    memmove(list->region + n + 1, list->region + n,
+            sizeof *list->region * (list->no - n));
+
+    list->region[n].start = start;
+    list->region[n].end = end;
+    list->region[n].type = type;
+    list->region[n].value = value;
+    list->no++;
+}
+
+const char *RegionTypeName(region_type_t type)
+{
+    int f;
+
+    for(f = 0; type_table[f].name; f++)
+    {
+        if (type_table[f].type == type)
+        {
+            return type_table[f].name;
+        }
+    }
+
+    return "code";
+}
+
+void RegionAddGaps(region_list_t *list, word start, word end,
+                   region_type_t type, byte value)
+{
+    ulong from = start;
+    int r = RegionNext(list, start);
+
+    while(from <= end)
+    {
+        ulong covered_start;
+        ulong covered_end;
+
+        if (r == list->no || list->region[r].start > end)
+        {
+            RegionAdd(list, (word)from, end, type, value);
+            break;
+        }
+
+        covered_start = list->region[r].start;
+        covered_end = list->region[r].end;
+        r++;
+
+        if (covered_start > from)
+        {
+            RegionAdd(list, (word)from, (word)(covered_start - 1), type,
+                      value);
+            r++;
+        }
+
+        from = covered_end + 1;
+    }
+}
+
+void RegionFree(region_list_t *list)
+{
+    free(list->region);
+    list->region = NULL;
+    list->no = 0;
+    list->alloc = 0;
+}
+
+int RegionLoad(region_list_t *list, const char *path)
+{
+    image_t img;
+    const byte *p;
+    const byte *end;
+    ulong line_no = 1;
+    int f;
+
+    if (!ImageOpen(&img, path))
+    {
+        fprintf(stderr, "dasm: cannot read map %s\n", path);
+        return FALSE;
+    }
+
+    p = img.file;
+    end = p + img.file_size;
+
+    while(p < end)
+    {
+        const byte *eol = memchr(p, '\n', (size_t)(end - p));
+        const char *error;
+
+        if (!eol)
+        {
+            eol = end;
+        }
+
+        if ((error = ParseLine(list, p, eol)))
+        {
+            fprintf(stderr, "dasm: bad map %s: line %lu: %s\n",
+                            path, line_no, error);
+            ImageClose(&img);
+            return FALSE;
+        }
+
+        p = eol + 1;
+        line_no++;
+    }
+
+    ImageClose(&img);
+
+    for(f = 1; f < list->no; f++)
+    {
+        if (list->region[f].start <= list->region[f - 1].end)
+        {
+            fprintf(stderr, "dasm: bad map %s: $%4.4x-$%4.4x overlaps "
+                            "$%4.4x-$%4.4x\n", path,
+                            list->region[f].start, list->region[f].end,
+                            list->region[f - 1].start,
+                            list->region[f - 1].end);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+void RegionFindFills(region_list_t *list, const byte *data, ulong size,
+                     word address, ulong min_run,
+                     const region_list_t *exclude)
+{
+    int x = exclude ? RegionNext(exclude, address) : 0;
+    ulong pos = 0;
+
+    if (min_run < 2)
+    {
+        min_run = 2;
+    }
+
+    while(pos < size)
+    {
+        ulong limit = size - pos;
+        ulong n;
+
+        if (exclude && x < exclude->no)
+        {
+            const region_t *r = exclude->region + x;
+
+            if (r->start <= address + pos)
+            {
+                pos = r->end + 1 - address;
+                x++;
+                continue;
+            }
+
+            if (r->start - (address + pos) < limit)
+            {
+                limit = r->start - (address + pos);
+            }
+        }
+
+        n = RunLength(data + pos, limit);
+
+        if (n >= min_run)
+        {
+            RegionAdd(list, address + pos, address + pos + n - 1,
+                      eRegionFill, data[pos]);
+        }
+
+        pos += n;
+    }
+}
+
+void RegionFindText(region_list_t *list, const byte *data, ulong size,
+                    word address, charset_t charset, ulong min_run, int bit7,
+                    const region_list_t *exclude)
+{
+    byte class[256];
+    int x = exclude ? RegionNext(exclude, address) : 0;
+    ulong pos = 0;
+
+    BuildClasses(charset, class);
+
+    if (min_run < 2)
+    {
+        min_run = 2;
+    }
+
+    while(pos < size)
+    {
+        ulong limit = size;
+
+        if (exclude && x < exclude->no)
+        {
+            const region_t *r = exclude->region + x;
+
+            if (r->start <= address + pos)
+            {
+                pos = r->end + 1 - address;
+                x++;
+                continue;
+            }
+
+            if (r->start - address < limit)
+            {
+                limit = r->start - address;
+            }
+        }
+
+        FindText(list, data, pos, limit, address, class, min_run, bit7);
+        pos = limit;
+    }
+}
+
+int RegionCharset(const char *name, charset_t *charset)
+{
+    int f;
+
+    for(f = 0; charset_table[f].name; f++)
+    {
+        if (strcmp(charset_table[f].name, name) == 0)
+        {
+            *charset = charset_table[f].charset;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+int RegionNext(const region_list_t *list, word address)
+{
+    int lo = 0;
+    int hi = list->no;
+
+    while(lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+
+        if (list->region[mid].end < address)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,123 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Regions of an image that are not disassembled as code.
+
+*/
+
+#ifndef DASM_REGION_H
+#define DASM_REGION_H
+
+#include "global.h"
+
+typedef enum
+{
+    eRegionCode,        /* Disassembled as normal */
+    eRegionFill,        /* A run of one repeated byte */
+    eRegionByte,        /* Listed as db */
+    eRegionWord,        /* Listed as dw */
+    eRegionText,        /* Listed as db with quoted strings */
+    eRegionTable,       /* Listed as dw, each word the address of code */
+    eRegionSkip         /* Left out of the listing */
+} region_type_t;
+
+/* Character sets looked for by RegionFindText()
+*/
+typedef enum
+{
+    eCharsetASCII,
+    eCharsetPETSCII,
+    eCharsetZX
+} charset_t;
+
+typedef struct
+{
+    word                start;
+    word                end;            /* Address of the last byte */
+    region_type_t       type;
+    byte                value;          /* The byte of a fill */
+} region_t;
+
+/* A list of regions sorted by start address, which do not overlap
+*/
+typedef struct
+{
+    int         no;
+    int         alloc;
+    region_t    *region;
+} region_list_t;
+
+#define INIT_REGION_LIST        {0}
+
+void RegionAdd(region_list_t *list, word start, word end,
+               region_type_t type, byte value);
+
+/* Returns the name of a type of region as a map file gives it
+*/
+const char *RegionTypeName(region_type_t type);
+
+/* Adds the parts of start to end that are not already in a region of list
+*/
+void RegionAddGaps(region_list_t *list, word start, word end,
+                   region_type_t type, byte value);
+
+void RegionFree(region_list_t *list);
+
+/* Reads a map file of regions, one per line as "start end type" where the
+   addresses are hex, the end is inclusive and the type is one of code,
+   byte, word, text, table or skip.  The start and end may also be joined
+   with a '-'.  Blank lines and anything after a ';' or '#' are ignored.
+   Returns FALSE after reporting an error.
+*/
+int RegionLoad(region_list_t *list, const char *path);
+
+/* Adds a fill region for every run of at least min_run identical bytes in
+   data, which is loaded at address.  Runs are not looked for inside the
+   regions of exclude, which may be NULL.
+*/
+void RegionFindFills(region_list_t *list, const byte *data, ulong size,
+                     word address, ulong min_run,
+                     const region_list_t *exclude);
+
+/* Adds a text region for every run of at least min_run characters of
+   charset in data, which is loaded at address, that is mostly letters and
+   spaces.  With bit7 a run may end with a character that has its top bit
+   set, as many programs mark the end of a string.  Runs are not looked for
+   inside the regions of exclude, which may be NULL.
+*/
+void RegionFindText(region_list_t *list, const byte *data, ulong size,
+                    word address, charset_t charset, ulong min_run, int bit7,
+                    const region_list_t *exclude);
+
+/* Finds a character set by name, returning FALSE if there is none
+*/
+int RegionCharset(const char *name, charset_t *charset);
+
+/* Returns the index of the first region that ends at or after address, or
+   list->no if there is none.
+*/
+int RegionNext(const region_list_t *list, word address);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,601 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Inverted indexes of the instructions of many files.
+
+    An index is built in memory as a list of records, one for every key of
+    every instruction, which is sorted and then written out a key at a time.
+    A loaded index is searched in place: finding a key is a binary search
+    and its postings are decoded as they are read, so a query costs the
+    number of postings it reads, and a query on both an opcode and an
+    operand walks the two lists together.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "search.h"
+#include "util.h"
+
+#define VERSION         1
+#define HEADER_SIZE     28
+#define KEY_SIZE        16
+
+
+/* ---------------------------------------- TYPES
+*/
+
+/* A position in the postings of a key
+*/
+typedef struct
+{
+    const byte  *p;
+    const byte  *end;
+    ulong       left;
+    ulong       file;
+    word        address;
+} cursor_t;
+
+typedef struct
+{
+    byte        *data;
+    ulong       no;
+    ulong       alloc;
+} buffer_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+static void AddByte(buffer_t *b, byte c)
+{
+    if (b->no == b->alloc)
+    {
+        b->alloc = b->alloc ? b->alloc * 2 : 0x10000;
+        b->data = Alloc(b->data, b->alloc);
+    }
+
+    b->data[b->no++] = c;
+}
+
+static void AddVarint(buffer_t *b, ulong n)
+{
+    while(n >= 0x80)
+    {
+        AddByte(b, (byte)(n & 0x7f) | 0x80);
+        n >>= 7;
+    }
+
+    AddByte(b, (byte)n);
+}
+
+static void Add32(buffer_t *b, ulong n)
+{
+    AddByte(b, (byte)(n & 0xff));
+    AddByte(b, (byte)((n >> 8) & 0xff));
+    AddByte(b, (byte)((n >> 16) & 0xff));
+    AddByte(b, (byte)((n >> 24) & 0xff));
+}
+
+static int GetVarint(const byte **p, const byte *end, ulong *n)
+{
+    int shift = 0;
+
+    *n = 0;
+
+    while(*p < end && shift < 32)
+    {
+        byte c = *(*p)++;
+
+        *n |= (ulong)(c & 0x7f) << shift;
+
+        if (!(c & 0x80))
+        {
+            return TRUE;
+        }
+
+        shift += 7;
+    }
+
+    return FALSE;
+}
+
+static void AddRecord(search_t *db, search_kind kind, ulong key, ulong file,
+                      word address)
+{
+    search_record_t *r;
+
+    if (db->no == db->alloc)
+    {
+        db->alloc = db->alloc ? db->alloc * 2 : 0x1000;
+        db->record = Alloc(db->record, sizeof *db->record * db->alloc);
+    }
+
+    r = db->record + db->no++;
+    r->kind = kind;
+    r->key = key;
+    r->file = file;
+    r->address = address;
+}
+
+static int CompareKey(search_kind ka, ulong a, search_kind kb, ulong b)
+{
+    if (ka != kb)
+    {
+        return ka < kb ? -1 : 1;
+    }
+
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+static int ComparePosting(ulong fa, word a, ulong fb, word b)
+{
+    if (fa != fb)
+    {
+        return fa < fb ? -1 : 1;
+    }
+
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+static int CompareRecord(const void *a, const void *b)
+{
+    const search_record_t *ra = a;
+    const search_record_t *rb = b;
+    int c = CompareKey(ra->kind, ra->key, rb->kind, rb->key);
+
+    return c ? c : ComparePosting(ra->file, ra->address,
+                                  rb->file, rb->address);
+}
+
+static int FindFile(const search_t *db, const char *name)
+{
+    int f;
+
+    for(f = 0; f < db->files; f++)
+    {
+        if (strcmp(db->name[f], name) == 0)
+        {
+            return f;
+        }
+    }
+
+    return -1;
+}
+
+static void AddFile(search_t *db, const char *name)
+{
+    db->name = Alloc(db->name, sizeof *db->name * (size_t)(db->files + 1));
+    db->name[db->files++] = CopyString(name);
+}
+
+/* Sets c to the start of the postings of key n of a loaded index
+*/
+static void Open(const search_t *db, ulong n, cursor_t *c)
+{
+    const byte *k = db->key + n * KEY_SIZE;
+    ulong offset = Get32(k + 12);
+
+    c->p = db->postings + (offset < db->size ? offset : db->size);
+    c->end = db->postings + db->size;
+    c->left = Get32(k + 8);
+    c->file = 0;
+    c->address = 0;
+}
+
+/* Sets c to the postings of a key, or to none if it is not in the index
+*/
+static void Find(const search_t *db, search_kind kind, ulong key,
+                 cursor_t *c)
+{
+    ulong lo = 0;
+    ulong hi = db->keys;
+
+    while(lo < hi)
+    {
+        ulong mid = lo + (hi - lo) / 2;
+        const byte *k = db->key + mid * KEY_SIZE;
+
+        if (CompareKey((search_kind)Get32(k), Get32(k + 4), kind, key) < 0)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    if (lo < db->keys &&
+        CompareKey((search_kind)Get32(db->key + lo * KEY_SIZE),
+                   Get32(db->key + lo * KEY_SIZE + 4), kind, key) == 0)
+    {
+        Open(db, lo, c);
+    }
+    else
+    {
+        memset(c, 0, sizeof *c);
+    }
+}
+
+/* Moves to the next posting, returning FALSE at the end
+*/
+static int Next(cursor_t *c)
+{
+    ulong file;
+    ulong address;
+
+    if (c->left == 0 ||
+        !GetVarint(&c->p, c->end, &file) ||
+        !GetVarint(&c->p, c->end, &address))
+    {
+        c->left = 0;
+        return FALSE;
+    }
+
+    c->left--;
+
+    if (file)
+    {
+        c->file += file;
+        c->address = (word)address;
+    }
+    else
+    {
+        c->address += (word)address;
+    }
+
+    return TRUE;
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void SearchInit(search_t *db, const char *cpu)
+{
+    memset(db, 0, sizeof *db);
+    CopyName(db->cpu, sizeof db->cpu, cpu);
+}
+
+int SearchLoad(search_t *db, const char *path)
+{
+    const byte *p;
+    ulong end;
+    ulong pos;
+    int f;
+
+    memset(db, 0, sizeof *db);
+
+    if (!ImageOpen(&db->file, path))
+    {
+        fprintf(stderr, "dasm: cannot read index %s\n", path);
+        return FALSE;
+    }
+
+    p = db->file.file;
+    end = db->file.file_size;
+
+    if (end < HEADER_SIZE || memcmp(p, "DINV", 4) ||
+        Get32(p + 4) != VERSION)
+    {
+        fprintf(stderr, "dasm: %s is not an instruction index\n", path);
+        ImageClose(&db->file);
+        return FALSE;
+    }
+
+    memcpy(db->cpu, p + 8, SEARCH_CPU);
+    db->files = (int)Get32(p + 16);
+    db->keys = Get32(p + 20);
+    db->size = Get32(p + 24);
+    db->key = p + HEADER_SIZE;
+    db->loaded = TRUE;
+
+    pos = HEADER_SIZE;
+
+    if (db->files < 0 || db->keys > (end - pos) / KEY_SIZE ||
+        db->size > end - pos - db->keys * KEY_SIZE)
+    {
+        fprintf(stderr, "dasm: index %s is damaged\n", path);
+        SearchFree(db);
+        return FALSE;
+    }
+
+    pos += db->keys * KEY_SIZE;
+    db->postings = p + pos;
+    pos += db->size;
+
+    db->name = Alloc(NULL, sizeof *db->name * (size_t)db->files);
+
+    for(f = 0; f < db->files; f++)
+    {
+        const byte *name = p + pos;
+
+        while(pos < end && p[pos])
+        {
+            pos++;
+        }
+
+        if (pos++ == end)
+        {
+            fprintf(stderr, "dasm: index %s is damaged\n", path);
+            db->files = f;
+            SearchFree(db);
+            return FALSE;
+        }
+
+        db->name[f] = (char *)name;
+    }
+
+    return TRUE;
+}
+
+int SearchMerge(search_t *db, const search_t *other)
+{
+    ulong *file;
+    ulong n;
+    int f;
+
+    if (strcmp(db->cpu, other->cpu))
+    {
+        fprintf(stderr, "dasm: cannot merge a %s index with %s\n",
+                other->cpu, db->cpu);
+        return FALSE;
+    }
+
+    file = Alloc(NULL, sizeof *file * (size_t)(other->files + 1));
+
+    for(f = 0; f < other->files; f++)
+    {
+        if (FindFile(db, other->name[f]) != -1)
+        {
+            file[f] = (ulong)-1;
+        }
+        else
+        {
+            file[f] = (ulong)db->files;
+            AddFile(db, other->name[f]);
+        }
+    }
+
+    for(n = 0; n < other->keys; n++)
+    {
+        const byte *k = other->key + n * KEY_SIZE;
+        cursor_t c;
+
+        Open(other, n, &c);
+
+        while(Next(&c))
+        {
+            if (c.file < (ulong)other->files && file[c.file] != (ulong)-1)
+            {
+                AddRecord(db, (search_kind)Get32(k), Get32(k + 4),
+                          file[c.file], c.address);
+            }
+        }
+    }
+
+    free(file);
+
+    return TRUE;
+}
+
+int SearchAdd(search_t *db, const CPU *cpu, const image_t *img,
+              const char *name)
+{
+    ulong file = (ulong)db->files;
+    int n;
+
+    if (FindFile(db, name) != -1)
+    {
+        return FALSE;
+    }
+
+    AddFile(db, name);
+
+    for(n = 0; n < img->no; n++)
+    {
+        const segment_t *seg = img->segment + n;
+        word address = seg->address;
+        ulong pos = 0;
+
+        while(pos < seg->size)
+        {
+            decode_t d;
+            ulong len;
+
+            if (!(len = (ulong)cpu->decode(seg->data + pos, seg->size - pos,
+                                           address, &d)))
+            {
+                break;
+            }
+
+            AddRecord(db, eSearchOpcode,
+                      (ulong)(d.page & 0xff) << 8 | (ulong)(d.opcode & 0xff),
+                      file, address);
+
+            if (d.has_operand)
+            {
+                AddRecord(db, eSearchOperand, d.operand, file, address);
+            }
+
+            pos += len;
+            address += (word)len;
+        }
+    }
+
+    return TRUE;
+}
+
+int SearchWrite(search_t *db, const char *path)
+{
+    buffer_t keys = {NULL, 0, 0};
+    buffer_t postings = {NULL, 0, 0};
+    char cpu[SEARCH_CPU + 1];
+    ulong no = 0;
+    ulong n;
+    ulong first;
+    FILE *fp;
+    int f;
+
+    qsort(db->record, db->no, sizeof *db->record, CompareRecord);
+
+    for(first = 0; first < db->no; first = n)
+    {
+        const search_record_t *r = db->record + first;
+        ulong start = postings.no;
+        ulong file = 0;
+        word address = 0;
+
+        Add32(&keys, (ulong)r->kind);
+        Add32(&keys, r->key);
+
+        for(n = first; n < db->no &&
+                       CompareKey(db->record[n].kind, db->record[n].key,
+                                  r->kind, r->key) == 0; n++)
+        {
+            const search_record_t *p = db->record + n;
+
+            AddVarint(&postings, p->file - file);
+            AddVarint(&postings, p->file != file ? p->address
+                                                 : p->address - address);
+            file = p->file;
+            address = p->address;
+        }
+
+        Add32(&keys, n - first);
+        Add32(&keys, start);
+        no++;
+    }
+
+    if (!(fp = fopen(path, "wb")))
+    {
+        free(keys.data);
+        free(postings.data);
+        return FALSE;
+    }
+
+    memset(cpu, 0, sizeof cpu);
+    CopyName(cpu, sizeof cpu, db->cpu);
+
+    fwrite("DINV", 1, 4, fp);
+    Put32(fp, VERSION);
+    fwrite(cpu, 1, SEARCH_CPU, fp);
+    Put32(fp, (ulong)db->files);
+    Put32(fp, no);
+    Put32(fp, postings.no);
+    fwrite(keys.data, 1, keys.no, fp);
+    fwrite(postings.data, 1, postings.no, fp);
+
+    for(f = 0; f < db->files; f++)
+    {
+        fwrite(db->name[f], 1, strlen(db->name[f]) + 1, fp);
+    }
+
+    free(keys.data);
+    free(postings.data);
+
+    return fclose(fp) == 0;
+}
+
+void SearchFree(search_t *db)
+{
+    int f;
+
+    if (db->loaded)
+    {
+        ImageClose(&db->file);
+    }
+    else
+    {
+        for(f = 0; f < db->files; f++)
+        {
+            free(db->name[f]);
+        }
+    }
+
+    free(db->name);
+    free(db->record);
+    memset(db, 0, sizeof *db);
+}
+
+ulong SearchQuery(const search_t *db, long opcode, long operand, ulong max,
+                  FILE *fp)
+{
+    cursor_t a;
+    cursor_t b;
+    ulong no = 0;
+    int more;
+
+    if (opcode < 0 && operand < 0)
+    {
+        return 0;
+    }
+
+    if (opcode >= 0)
+    {
+        Find(db, eSearchOpcode, (ulong)opcode, &a);
+    }
+    else
+    {
+        Find(db, eSearchOperand, (ulong)operand, &a);
+    }
+
+    /* With both, b follows a through the operand postings
+    */
+    if (opcode >= 0 && operand >= 0)
+    {
+        Find(db, eSearchOperand, (ulong)operand, &b);
+        more = Next(&b);
+    }
+    else
+    {
+        more = TRUE;
+    }
+
+    while(more && (!max || no < max) && Next(&a))
+    {
+        if (opcode >= 0 && operand >= 0)
+        {
+            while(more && ComparePosting(b.file, b.address,
+                                         a.file, a.address) < 0)
+            {
+                more = Next(&b);
+            }
+
+            if (!more || ComparePosting(b.file, b.address,
+                                        a.file, a.address) != 0)
+            {
+                continue;
+            }
+        }
+
+        fprintf(fp, "%s $%4.4x\n", a.file < (ulong)db->files ?
+                                        db->name[a.file] : "?", a.address);
+        no++;
+    }
+
+    return no;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
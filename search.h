@@ -0,0 +1,128 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Inverted indexes of the instructions of many files.
+
+    Every instruction is posted under its opcode, as (page << 8 | opcode),
+    and under its operand if it has one.  An index file is little-endian
+    and laid out as
+
+        "DINV"
+        u32     version (1)
+        char    cpu[8]          NUL padded
+        u32     files
+        u32     keys
+        u32     size of the postings
+
+    followed by the keys, each a u32 kind (0 for an opcode, 1 for an
+    operand), u32 key, u32 number of postings and u32 offset of its postings,
+    sorted by kind and key.  Then come the postings, and then the names of
+    the files as NUL terminated strings.
+
+    The postings of a key are sorted by file and address.  Each is the
+    difference from the file number of the one before followed by the
+    difference from its address, or the address itself if the file has
+    changed, both as unsigned 7-bit varints with the top bit set on every
+    byte but the last.
+
+*/
+
+#ifndef DASM_SEARCH_H
+#define DASM_SEARCH_H
+
+#include <stdio.h>
+
+#include "global.h"
+#include "decode.h"
+#include "image.h"
+
+#define SEARCH_CPU      8
+
+typedef enum
+{
+    eSearchOpcode,
+    eSearchOperand
+} search_kind;
+
+typedef struct
+{
+    search_kind kind;
+    ulong       key;
+    ulong       file;
+    word        address;
+} search_record_t;
+
+typedef struct
+{
+    char                cpu[SEARCH_CPU + 1];
+    int                 files;
+    char                **name;
+    ulong               no;
+    ulong               alloc;
+    search_record_t     *record;        /* Unless loaded */
+
+    /* Private
+    */
+    image_t             file;
+    ulong               keys;
+    const byte          *key;
+    const byte          *postings;
+    ulong               size;
+    int                 loaded;
+} search_t;
+
+/* Starts an empty index
+*/
+void SearchInit(search_t *db, const char *cpu);
+
+/* Maps an index file for SearchQuery() or SearchMerge().  Returns FALSE
+   after reporting an error.
+*/
+int SearchLoad(search_t *db, const char *path);
+
+/* Adds the files and postings of a loaded index to one started with
+   SearchInit(), skipping files it already holds.  Returns FALSE after
+   reporting an error if they are for another CPU.
+*/
+int SearchMerge(search_t *db, const search_t *other);
+
+/* Adds the instructions of every segment of img under name.  Returns FALSE
+   if name is already in the index.
+*/
+int SearchAdd(search_t *db, const CPU *cpu, const image_t *img,
+              const char *name);
+
+int SearchWrite(search_t *db, const char *path);
+
+void SearchFree(search_t *db);
+
+/* Writes the file and address of up to max instructions, or all of them if
+   max is 0, with the opcode and operand given to fp.  Either may be -1 to
+   match any.  Returns the number written.
+*/
+ulong SearchQuery(const search_t *db, long opcode, long operand, ulong max,
+                  FILE *fp);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
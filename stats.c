@@ -0,0 +1,408 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Opcode statistics over many files.
+
+    Each thread takes the next file from a shared counter and adds what it
+    decodes to counters of its own, so the threads share nothing else until
+    their counters are added together at the end.  Files are only decoded,
+    never listed.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#if (defined(__unix__) || defined(__APPLE__)) && \
+    defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && \
+    !defined(__STDC_NO_ATOMICS__)
+#define USE_THREADS
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+#include "stats.h"
+#include "image.h"
+#include "loader.h"
+#include "util.h"
+
+#define MAX_THREADS     64
+
+/* Files with fewer instructions say too little to be outliers
+*/
+#define MIN_INSTRUCTIONS 0x100
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    ulong       instructions;
+    ulong       illegal;
+    int         ok;
+} file_t;
+
+typedef struct
+{
+    stats_t     stats;
+#ifdef USE_THREADS
+    pthread_t   thread;
+#endif
+} worker_t;
+
+typedef struct
+{
+    ulong       count;
+    int         page;
+    int         opcode;
+} row_t;
+
+
+/* ---------------------------------------- GLOBALS
+*/
+static const CPU *stats_cpu;
+static char *const *stats_path;
+static int stats_no;
+static word stats_origin;
+static file_t *file;
+
+#ifdef USE_THREADS
+static atomic_int next_file;
+#else
+static int next_file;
+#endif
+
+
+/* ---------------------------------------- UTILS
+*/
+static void CountFile(int n, stats_t *s)
+{
+    image_t img;
+    file_t *f = file + n;
+    int seg;
+
+    if (!ImageOpen(&img, stats_path[n]))
+    {
+        fprintf(stderr, "dasm: cannot read %s\n", stats_path[n]);
+        return;
+    }
+
+    if (!LoadImage(&img, stats_path[n], stats_origin))
+    {
+        ImageClose(&img);
+        return;
+    }
+
+    for(seg = 0; seg < img.no; seg++)
+    {
+        const segment_t *sg = img.segment + seg;
+        word address = sg->address;
+        ulong pos = 0;
+
+        while(pos < sg->size)
+        {
+            decode_t d;
+            ulong len;
+
+            if (!(len = (ulong)stats_cpu->decode(sg->data + pos,
+                                                 sg->size - pos,
+                                                 address, &d)))
+            {
+                break;
+            }
+
+            if (d.page >= 0 && d.page < STATS_PAGES)
+            {
+                s->count[d.page][d.opcode & 0xff]++;
+            }
+
+            f->instructions++;
+            f->illegal += d.illegal ? 1 : 0;
+
+            pos += len;
+            address += (word)len;
+        }
+    }
+
+    s->instructions += f->instructions;
+    s->illegal += f->illegal;
+    f->ok = TRUE;
+
+    ImageClose(&img);
+}
+
+static int NextFile(void)
+{
+#ifdef USE_THREADS
+    return atomic_fetch_add(&next_file, 1);
+#else
+    return next_file++;
+#endif
+}
+
+static void *Work(void *arg)
+{
+    worker_t *w = arg;
+    int n;
+
+    while((n = NextFile()) < stats_no)
+    {
+        CountFile(n, &w->stats);
+    }
+
+    return NULL;
+}
+
+static int Threads(void)
+{
+#ifdef USE_THREADS
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n < 1 ? 1 : n > MAX_THREADS ? MAX_THREADS : (int)n;
+#else
+    return 1;
+#endif
+}
+
+static double Share(ulong n, ulong total)
+{
+    return total ? (double)n * 100.0 / (double)total : 0.0;
+}
+
+static int CompareRow(const void *a, const void *b)
+{
+    const row_t *ra = a;
+    const row_t *rb = b;
+
+    if (ra->count != rb->count)
+    {
+        return ra->count > rb->count ? -1 : 1;
+    }
+
+    if (ra->page != rb->page)
+    {
+        return ra->page < rb->page ? -1 : 1;
+    }
+
+    return ra->opcode - rb->opcode;
+}
+
+static int CompareIllegal(const void *a, const void *b)
+{
+    const file_t *fa = file + *(const int *)a;
+    const file_t *fb = file + *(const int *)b;
+    double sa = Share(fa->illegal, fa->instructions);
+    double sb = Share(fb->illegal, fb->instructions);
+
+    if (sa != sb)
+    {
+        return sa > sb ? -1 : 1;
+    }
+
+    return *(const int *)a - *(const int *)b;
+}
+
+static void WriteOpcodes(const stats_t *s, FILE *fp)
+{
+    row_t *row = AllocClear(sizeof *row * STATS_PAGES * 256);
+    int no = 0;
+    int p;
+    int n;
+
+    for(p = 0; p < STATS_PAGES; p++)
+    {
+        for(n = 0; n < 256; n++)
+        {
+            if (s->count[p][n])
+            {
+                row[no].count = s->count[p][n];
+                row[no].page = p;
+                row[no].opcode = n;
+                no++;
+            }
+        }
+    }
+
+    qsort(row, (size_t)no, sizeof *row, CompareRow);
+
+    fprintf(fp, "page opcode %12s %8s\n", "count", "share");
+
+    for(n = 0; n < no; n++)
+    {
+        fprintf(fp, "%4d     %2.2x %12lu %7.3f%%\n", row[n].page,
+                row[n].opcode, row[n].count,
+                Share(row[n].count, s->instructions));
+    }
+
+    free(row);
+}
+
+/* Lists the files whose share of illegal opcodes is more than two standard
+   deviations above the mean
+*/
+static void WriteOutliers(FILE *fp)
+{
+    int *order = AllocClear(sizeof *order * (size_t)stats_no);
+    double sum = 0;
+    double sum2 = 0;
+    double mean;
+    double sd;
+    int used = 0;
+    int no = 0;
+    int n;
+
+    for(n = 0; n < stats_no; n++)
+    {
+        if (file[n].ok && file[n].instructions >= MIN_INSTRUCTIONS)
+        {
+            double share = Share(file[n].illegal, file[n].instructions);
+
+            sum += share;
+            sum2 += share * share;
+            used++;
+        }
+    }
+
+    if (used < 2)
+    {
+        free(order);
+        return;
+    }
+
+    mean = sum / used;
+    sd = sqrt(fabs(sum2 / used - mean * mean));
+
+    for(n = 0; n < stats_no; n++)
+    {
+        if (file[n].ok && file[n].instructions >= MIN_INSTRUCTIONS &&
+            Share(file[n].illegal, file[n].instructions) > mean + 2 * sd)
+        {
+            order[no++] = n;
+        }
+    }
+
+    qsort(order, (size_t)no, sizeof *order, CompareIllegal);
+
+    fprintf(fp, "\nillegal opcodes: mean %.2f%%, deviation %.2f%%\n",
+            mean, sd);
+
+    for(n = 0; n < no && n < STATS_OUTLIERS; n++)
+    {
+        const file_t *f = file + order[n];
+
+        fprintf(fp, "%7.2f%% %s\n", Share(f->illegal, f->instructions),
+                stats_path[order[n]]);
+    }
+
+    free(order);
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int Stats(const CPU *cpu, char *const *path, int no, word origin, FILE *fp)
+{
+    worker_t *worker;
+    stats_t total;
+    int threads = Threads();
+    int ok = TRUE;
+    int started = 1;
+    int n;
+    int p;
+
+    stats_cpu = cpu;
+    stats_path = path;
+    stats_no = no;
+    stats_origin = origin;
+    file = AllocClear(sizeof *file * (size_t)(no ? no : 1));
+    next_file = 0;
+
+    if (threads > no)
+    {
+        threads = no ? no : 1;
+    }
+
+    worker = AllocClear(sizeof *worker * (size_t)threads);
+
+    /* The main thread is the first worker
+    */
+#ifdef USE_THREADS
+    while(started < threads &&
+          pthread_create(&worker[started].thread, NULL, Work,
+                         worker + started) == 0)
+    {
+        started++;
+    }
+#endif
+
+    Work(worker);
+
+#ifdef USE_THREADS
+    for(n = 1; n < started; n++)
+    {
+        pthread_join(worker[n].thread, NULL);
+    }
+#endif
+
+    memset(&total, 0, sizeof total);
+
+    for(n = 0; n < started; n++)
+    {
+        const stats_t *s = &worker[n].stats;
+
+        for(p = 0; p < STATS_PAGES; p++)
+        {
+            int op;
+
+            for(op = 0; op < 256; op++)
+            {
+                total.count[p][op] += s->count[p][op];
+            }
+        }
+
+        total.instructions += s->instructions;
+        total.illegal += s->illegal;
+    }
+
+    for(n = 0; n < no; n++)
+    {
+        ok = ok && file[n].ok;
+    }
+
+    fprintf(fp, "%s: %d files, %lu instructions, %lu illegal (%.2f%%)\n\n",
+            cpu->name, no, total.instructions, total.illegal,
+            Share(total.illegal, total.instructions));
+
+    WriteOpcodes(&total, fp);
+    WriteOutliers(fp);
+
+    free(worker);
+    free(file);
+
+    return ok;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,60 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Opcode statistics over many files.
+
+*/
+
+#ifndef DASM_STATS_H
+#define DASM_STATS_H
+
+#include <stdio.h>
+
+#include "global.h"
+#include "decode.h"
+
+/* Opcode pages counted, enough for every processor
+*/
+#define STATS_PAGES     8
+
+/* The most files listed for their share of illegal opcodes
+*/
+#define STATS_OUTLIERS  20
+
+typedef struct
+{
+    ulong       count[STATS_PAGES][256];
+    ulong       instructions;
+    ulong       illegal;
+} stats_t;
+
+/* Decodes every file in path with a linear sweep, on as many threads as
+   there are processors, and writes the number of times each opcode was
+   used and the files with an unusual share of illegal opcodes to fp.
+   Returns FALSE if any file could not be read.
+*/
+int Stats(const CPU *cpu, char *const *path, int no, word origin, FILE *fp);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,327 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Pointer and jump tables.
+
+    A linear sweep of the segment first marks where instructions start,
+    where routines may start and which bytes are in the excluded regions.
+    The words at even and at odd offsets are then each walked once,
+    counting how many in a row point at code, and the runs long enough
+    from the two walks are merged, keeping the longer of any that overlap.
+    Checking a word costs at most TABLE_DECODE decodes, so the whole search
+    is linear in the segment.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "table.h"
+#include "util.h"
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    ulong       pos;
+    ulong       entries;
+} run_t;
+
+typedef struct
+{
+    run_t       *run;
+    ulong       no;
+    ulong       alloc;
+} run_list_t;
+
+typedef struct
+{
+    const CPU           *cpu;
+    const segment_t     *seg;
+    byte                *start;         /* Bit set where a line starts */
+    byte                *entry;         /* Bit set where a routine may */
+    byte                *excluded;      /* Bit set in excluded regions */
+} scan_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+static int Bit(const byte *bits, ulong pos)
+{
+    return (bits[pos / 8] >> (pos % 8)) & 1;
+}
+
+static void SetBit(byte *bits, ulong pos)
+{
+    bits[pos / 8] |= (byte)(1 << (pos % 8));
+}
+
+/* Marks the line starts and excluded bytes the way the segment is listed.
+   A routine may start at the start of the segment, after an excluded
+   region or an instruction that does not fall through, or at the target of
+   an instruction.
+*/
+static void Sweep(scan_t *s, const region_list_t *exclude)
+{
+    const segment_t *seg = s->seg;
+    word address = seg->address;
+    ulong pos = 0;
+    int r = exclude ? RegionNext(exclude, address) : 0;
+    int ended = TRUE;
+
+    while(pos < seg->size)
+    {
+        const region_t *reg = exclude && r < exclude->no ?
+                                        exclude->region + r : NULL;
+        decode_t d;
+        ulong len;
+
+        if (reg && address > reg->end)
+        {
+            r++;
+            continue;
+        }
+
+        if (reg && address >= reg->start)
+        {
+            ulong end = pos + (ulong)(reg->end - address) + 1;
+
+            for(len = pos; len < end && len < seg->size; len++)
+            {
+                SetBit(s->excluded, len);
+            }
+
+            len = end - pos;
+            ended = TRUE;
+        }
+        else if ((len = (ulong)s->cpu->decode(seg->data + pos,
+                                              seg->size - pos,
+                                              address, &d)))
+        {
+            ulong t = (word)(d.target - seg->address);
+
+            SetBit(s->start, pos);
+
+            if (ended)
+            {
+                SetBit(s->entry, pos);
+            }
+
+            if (d.has_target && t < seg->size)
+            {
+                SetBit(s->entry, t);
+            }
+
+            ended = !d.conditional && (d.flow == eFlowJump ||
+                                       d.flow == eFlowReturn ||
+                                       d.flow == eFlowIndirect);
+        }
+        else
+        {
+            break;
+        }
+
+        pos += len;
+        address += (word)len;
+    }
+}
+
+/* Returns TRUE if a routine may start at address and its first
+   instructions are complete and legal
+*/
+static int IsCode(const scan_t *s, word address)
+{
+    const segment_t *seg = s->seg;
+    ulong pos = (word)(address - seg->address);
+    int n;
+
+    if (pos >= seg->size || !Bit(s->start, pos) || !Bit(s->entry, pos))
+    {
+        return FALSE;
+    }
+
+    for(n = 0; n < TABLE_DECODE; n++)
+    {
+        decode_t d;
+        ulong len;
+
+        if (pos >= seg->size || !Bit(s->start, pos) ||
+            !(len = (ulong)s->cpu->decode(seg->data + pos, seg->size - pos,
+                                          address, &d)) ||
+            d.illegal)
+        {
+            return FALSE;
+        }
+
+        if (!d.conditional && (d.flow == eFlowJump ||
+                               d.flow == eFlowReturn ||
+                               d.flow == eFlowIndirect))
+        {
+            break;
+        }
+
+        pos += len;
+        address += (word)len;
+    }
+
+    return TRUE;
+}
+
+static void AddRun(run_list_t *list, ulong pos, ulong entries)
+{
+    if (list->no == list->alloc)
+    {
+        list->alloc = list->alloc ? list->alloc * 2 : 16;
+        list->run = Alloc(list->run, sizeof *list->run * list->alloc);
+    }
+
+    list->run[list->no].pos = pos;
+    list->run[list->no].entries = entries;
+    list->no++;
+}
+
+/* Finds the runs of words pointing at code that start at offsets of the
+   same parity as pos.  A word the same as the one before it ends a run, so
+   that padding is not taken for a table.
+*/
+static void FindRuns(const scan_t *s, ulong pos, ulong min_entries,
+                     run_list_t *list)
+{
+    const segment_t *seg = s->seg;
+    ulong entries = 0;
+    ulong first = 0;
+    word last = 0;
+
+    for(; pos + 1 < seg->size; pos += 2)
+    {
+        word w = GetWord(seg->data + pos, s->cpu->msb);
+        int points = !Bit(s->excluded, pos) && !Bit(s->excluded, pos + 1) &&
+                     IsCode(s, w);
+
+        if (points && entries && w != last)
+        {
+            entries++;
+            last = w;
+            continue;
+        }
+
+        if (entries >= min_entries)
+        {
+            AddRun(list, first, entries);
+        }
+
+        entries = points ? 1 : 0;
+        first = pos;
+        last = w;
+    }
+
+    if (entries >= min_entries)
+    {
+        AddRun(list, first, entries);
+    }
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void TableFind(region_list_t *list, const CPU *cpu, const segment_t *seg,
+               ulong min_entries, const region_list_t *exclude)
+{
+    run_list_t even = {0};
+    run_list_t odd = {0};
+    run_list_t found = {0};
+    scan_t s;
+    ulong e = 0;
+    ulong o = 0;
+    ulong f;
+
+    if (min_entries < 2)
+    {
+        min_entries = 2;
+    }
+
+    s.cpu = cpu;
+    s.seg = seg;
+    s.start = AllocClear(seg->size / 8 + 1);
+    s.entry = AllocClear(seg->size / 8 + 1);
+    s.excluded = AllocClear(seg->size / 8 + 1);
+
+    Sweep(&s, exclude);
+    FindRuns(&s, 0, min_entries, &even);
+    FindRuns(&s, 1, min_entries, &odd);
+
+    /* Both lists are in order, so take the earlier run each time and let
+       it replace the last one kept if they overlap and it is longer
+    */
+    while(e < even.no || o < odd.no)
+    {
+        const run_t *r;
+
+        if (o == odd.no ||
+            (e < even.no && even.run[e].pos < odd.run[o].pos))
+        {
+            r = even.run + e++;
+        }
+        else
+        {
+            r = odd.run + o++;
+        }
+
+        if (found.no)
+        {
+            run_t *last = found.run + found.no - 1;
+
+            if (r->pos < last->pos + last->entries * 2)
+            {
+                if (r->entries > last->entries)
+                {
+                    *last = *r;
+                }
+
+                continue;
+            }
+        }
+
+        AddRun(&found, r->pos, r->entries);
+    }
+
+    for(f = 0; f < found.no; f++)
+    {
+        word address = (word)(seg->address + found.run[f].pos);
+
+        RegionAdd(list, address,
+                  (word)(address + found.run[f].entries * 2 - 1),
+                  eRegionTable, 0);
+    }
+
+    free(even.run);
+    free(odd.run);
+    free(found.run);
+    free(s.start);
+    free(s.entry);
+    free(s.excluded);
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,54 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Pointer and jump tables.
+
+*/
+
+#ifndef DASM_TABLE_H
+#define DASM_TABLE_H
+
+#include "global.h"
+#include "decode.h"
+#include "image.h"
+#include "region.h"
+
+/* Instructions decoded at each address in a table to check it is code
+*/
+#define TABLE_DECODE    4
+
+/* Adds a table region for every run of at least min_entries little-endian
+   words in seg that each point at code in seg.  A word points at code if a
+   linear sweep of seg starts an instruction there that follows a jump,
+   return or data, or is the target of another instruction, and the
+   TABLE_DECODE instructions from it, or those up to a jump or return, are
+   all complete and legal.  No word of a table is the same as the one
+   before it.  Tables are not looked for, nor pointed into, inside the
+   regions of exclude, which may be NULL.
+*/
+void TableFind(region_list_t *list, const CPU *cpu, const segment_t *seg,
+               ulong min_entries, const region_list_t *exclude);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,393 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Precompiled mnemonic templates.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "template.h"
+
+/* Size of the template cache.  Must be a power of 2 and comfortably more than
+   the number of distinct format strings in all the decoders.
+*/
+#define CACHE_SIZE      2048
+
+static template_t *cache[CACHE_SIZE];
+
+static const char hex_digits[2][16] =
+{
+    {'0','1','2','3','4','5','6','7','8','9','a','b','c','d','e','f'},
+    {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F'}
+};
+
+
+static void Fatal(const char *format, const char *msg)
+{
+    fprintf(stderr, "dasm: bad template \"%s\": %s\n", format, msg);
+    exit(EXIT_FAILURE);
+}
+
+static void AddLiteral(template_t *t, int *len, char c)
+{
+    template_step_t *s;
+
+    if (*len >= MAX_TEMPLATE_TEXT)
+    {
+        Fatal(t->format, "literal text too long");
+    }
+
+    s = t->no > 0 ? t->step + t->no - 1 : NULL;
+
+    if (!s || s->op != eTplLiteral)
+    {
+        if (t->no == MAX_TEMPLATE_STEPS)
+        {
+            Fatal(t->format, "too many steps");
+        }
+
+        s = t->step + t->no++;
+        s->op = eTplLiteral;
+        s->prefixed = FALSE;
+        s->offset = (byte)*len;
+        s->length = 0;
+    }
+
+    t->text[0][*len] = c;
+    t->text[1][*len] = (char)toupper((unsigned char)c);
+    (*len)++;
+    s->length++;
+}
+
+static void AddOperand(template_t *t, int *len, template_op_t op)
+{
+    template_step_t *s;
+    int prefixed = FALSE;
+
+    /* Absorb a '$' directly before a hex number so the hex style can replace
+       it when rendering.
+    */
+    if (op >= eTplHex8 && op <= eTplHex32 && t->no > 0)
+    {
+        s = t->step + t->no - 1;
+
+        if (s->op == eTplLiteral && t->text[0][*len - 1] == '$')
+        {
+            prefixed = TRUE;
+            (*len)--;
+
+            if (--s->length == 0)
+            {
+                t->no--;
+            }
+        }
+    }
+
+    if (t->no == MAX_TEMPLATE_STEPS)
+    {
+        Fatal(t->format, "too many steps");
+    }
+
+    s = t->step + t->no++;
+    s->op = (byte)op;
+    s->prefixed = (byte)prefixed;
+    s->offset = 0;
+    s->length = 0;
+}
+
+static template_t *Compile(const char *format)
+{
+    template_t *t;
+    const char *p;
+    int len = 0;
+
+    t = malloc(sizeof *t);
+
+    if (!t)
+    {
+        Fatal(format, "out of memory");
+    }
+
+    t->format = format;
+    t->no = 0;
+
+    for(p = format; *p; p++)
+    {
+        int precision = 0;
+        int sign = FALSE;
+        int verbatim = FALSE;
+
+        if (*p != '%')
+        {
+            AddLiteral(t, &len, *p);
+            continue;
+        }
+
+        p++;
+
+        if (*p == '%')
+        {
+            AddLiteral(t, &len, '%');
+            continue;
+        }
+
+        if (*p == '+')
+        {
+            sign = TRUE;
+            p++;
+        }
+
+        if (*p == '#')
+        {
+            verbatim = TRUE;
+            p++;
+        }
+
+        while(isdigit((unsigned char)*p))
+        {
+            p++;
+        }
+
+        if (*p == '.')
+        {
+            precision = atoi(++p);
+
+            while(isdigit((unsigned char)*p))
+            {
+                p++;
+            }
+        }
+
+        switch(*p)
+        {
+            case 'x':
+                AddOperand(t, &len, precision > 6 ? eTplHex32 :
+                                    precision > 4 ? eTplHex24 :
+                                    precision > 2 ? eTplHex16 : eTplHex8);
+                break;
+
+            case 'd':
+                if (!sign)
+                {
+                    Fatal(format, "%d without sign not supported");
+                }
+
+                AddOperand(t, &len, eTplSigned);
+                break;
+
+            case 'u':
+                AddOperand(t, &len, eTplUnsigned);
+                break;
+
+            case 's':
+                AddOperand(t, &len, verbatim ? eTplText : eTplString);
+                break;
+
+            default:
+                Fatal(format, "unsupported conversion");
+                break;
+        }
+    }
+
+    return t;
+}
+
+static int Decimal(ulong value, char *buff)
+{
+    char tmp[32];
+    int n = 0;
+    int f;
+
+    do
+    {
+        tmp[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value);
+
+    for(f = 0; f < n; f++)
+    {
+        buff[f] = tmp[n - 1 - f];
+    }
+
+    return n;
+}
+
+const template_t *TemplateFind(const char *format)
+{
+    unsigned long h;
+
+    h = ((unsigned long)format >> 3) & (CACHE_SIZE - 1);
+
+    while(cache[h] && cache[h]->format != format)
+    {
+        h = (h + 1) & (CACHE_SIZE - 1);
+    }
+
+    if (!cache[h])
+    {
+        cache[h] = Compile(format);
+    }
+
+    return cache[h];
+}
+
+int TemplateHex(ulong value, int digits, int prefixed,
+                const template_style_t *style, char *buff)
+{
+    const char *hex = hex_digits[style->uppercase ? 1 : 0];
+    char *p = buff;
+    int n;
+
+    value &= 0xffffffffUL;
+
+    for(n = 8; n > digits && !(value >> ((n - 1) * 4)); n--)
+    {
+    }
+
+    if (prefixed)
+    {
+        switch(style->hex_style)
+        {
+            case eHexDollar:
+                *p++ = '$';
+                break;
+
+            case eHexC:
+                *p++ = '0';
+                *p++ = 'x';
+                break;
+
+            case eHexSuffix:
+                if ((value >> ((n - 1) * 4) & 0xf) > 9)
+                {
+                    *p++ = '0';
+                }
+                break;
+        }
+    }
+
+    while(n--)
+    {
+        *p++ = hex[(value >> (n * 4)) & 0xf];
+    }
+
+    if (prefixed && style->hex_style == eHexSuffix)
+    {
+        *p++ = style->uppercase ? 'H' : 'h';
+    }
+
+    return (int)(p - buff);
+}
+
+int TemplateRender(const template_t *t, const template_style_t *style,
+                   va_list va, char *buff)
+{
+    const char *text = t->text[style->uppercase ? 1 : 0];
+    char *p = buff;
+    ulong value;
+    int f;
+
+    for(f = 0; f < t->no; f++)
+    {
+        const template_step_t *s = t->step + f;
+        const char *str;
+        int i;
+
+        switch(s->op)
+        {
+            case eTplLiteral:
+                memcpy(p, text + s->offset, s->length);
+                p += s->length;
+                break;
+
+            case eTplHex8:
+                p += TemplateHex(va_arg(va, unsigned), 2, s->prefixed,
+                                 style, p);
+                break;
+
+            case eTplHex16:
+            case eTplHex24:
+            case eTplHex32:
+                value = va_arg(va, unsigned);
+                i = s->op == eTplHex16 ? 4 : s->op == eTplHex24 ? 6 : 8;
+
+                if (style->labelled && s->prefixed && value == style->label)
+                {
+                    *p++ = 'L';
+                    p += TemplateHex(value, 4, FALSE, style, p);
+                }
+                else
+                {
+                    p += TemplateHex(value, i, s->prefixed, style, p);
+                }
+                break;
+
+            case eTplSigned:
+                i = va_arg(va, int);
+
+                if (i < 0)
+                {
+                    *p++ = '-';
+                    p += Decimal((ulong)-(long)i, p);
+                }
+                else
+                {
+                    *p++ = '+';
+                    p += Decimal((ulong)i, p);
+                }
+                break;
+
+            case eTplUnsigned:
+                p += Decimal(va_arg(va, unsigned), p);
+                break;
+
+            case eTplString:
+            case eTplText:
+                str = va_arg(va, const char *);
+
+                if (style->uppercase && s->op == eTplString)
+                {
+                    while(*str)
+                    {
+                        *p++ = (char)toupper((unsigned char)*str++);
+                    }
+                }
+                else
+                {
+                    while(*str)
+                    {
+                        *p++ = *str++;
+                    }
+                }
+                break;
+        }
+    }
+
+    return (int)(p - buff);
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
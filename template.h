@@ -0,0 +1,106 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Precompiled mnemonic templates.
+
+    The format strings the decoders pass to Output() are compiled once into
+    a small program of literal runs and typed operands, which is then
+    executed for every line instead of going through the printf family.
+
+*/
+
+#ifndef DASM_TEMPLATE_H
+#define DASM_TEMPLATE_H
+
+#include <stdarg.h>
+#include "global.h"
+
+#define MAX_TEMPLATE_STEPS      16
+#define MAX_TEMPLATE_TEXT       64
+
+typedef enum
+{
+    eTplLiteral,        /* Literal run of text */
+    eTplHex8,           /* Hex number, at least 2 digits */
+    eTplHex16,          /* Hex number, at least 4 digits */
+    eTplHex24,          /* Hex number, at least 6 digits */
+    eTplHex32,          /* Hex number, at least 8 digits */
+    eTplSigned,         /* Signed decimal displacement, always with a sign */
+    eTplUnsigned,       /* Unsigned decimal */
+    eTplString,         /* String argument, eg. a register name */
+    eTplText            /* String argument kept as it is, eg. a file name */
+} template_op_t;
+
+typedef enum
+{
+    eHexDollar,         /* $1234 */
+    eHexC,              /* 0x1234 */
+    eHexSuffix          /* 1234h */
+} hex_style_t;
+
+typedef struct
+{
+    byte        op;             /* template_op_t */
+    byte        prefixed;       /* Hex number had a leading '$' */
+    byte        offset;         /* Literal offset into text */
+    byte        length;         /* Literal length */
+} template_step_t;
+
+typedef struct
+{
+    const char          *format;
+    int                 no;
+    template_step_t     step[MAX_TEMPLATE_STEPS];
+    char                text[2][MAX_TEMPLATE_TEXT];
+} template_t;
+
+/* Options that change how a template is rendered
+*/
+typedef struct
+{
+    int                 uppercase;
+    hex_style_t         hex_style;
+    int                 labelled;       /* Show label as a label */
+    ulong               label;
+} template_style_t;
+
+/* Returns the compiled template for a format string, compiling it on first
+   use.  Format strings are looked up by address, so must be static.
+*/
+const template_t *TemplateFind(const char *format);
+
+/* Renders a template to buff, returning the number of characters written.
+   The buffer must be large enough for the line.
+*/
+int TemplateRender(const template_t *t, const template_style_t *style,
+                   va_list va, char *buff);
+
+/* Writes a hex number of at least digits length to buff in the passed style,
+   returning the number of characters written.
+*/
+int TemplateHex(ulong value, int digits, int prefixed,
+                const template_style_t *style, char *buff);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,234 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Execution trace disassembly.
+
+    A trace visits the same few thousand instructions over and over, so each
+    (address, bytes) pair is only disassembled the first time it is seen.
+    The rendered line is kept in a direct mapped cache and later steps that
+    hit the same slot with the same address and bytes just write it out
+    again.  A collision simply replaces the old entry, so the cache never
+    grows past its fixed size.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+#include "output.h"
+#include "util.h"
+
+#define CACHE_BITS      16
+#define CACHE_SIZE      (1ul << CACHE_BITS)
+#define MAX_TRACE_BYTES MAX_INSTRUCTION
+#define MAX_CACHED_LINE 120
+
+#define FNV_OFFSET      2166136261ul
+#define FNV_PRIME       16777619ul
+
+
+/* ---------------------------------------- TYPES
+*/
+typedef struct
+{
+    word        address;
+    byte        no;             /* Number of bytes, 0 for an empty slot */
+    byte        len;            /* Length of the line */
+    byte        data[MAX_TRACE_BYTES];
+    char        line[MAX_CACHED_LINE];
+} entry_t;
+
+
+/* ---------------------------------------- UTILS
+*/
+/* Parses one trace line ending at eol, keeping the bits of the address in
+   mask.  Returns FALSE if it is not of the form "address[:] byte...".
+*/
+static int ParseLine(const byte *p, const byte *eol, word mask,
+                     word *address, byte *data, int *no)
+{
+    int digits = 0;
+
+    *address = 0;
+
+    while(p < eol && hex_value[*p] >= 0)
+    {
+        *address = (*address << 4 | (word)hex_value[*p++]) & mask;
+        digits++;
+    }
+
+    if (digits == 0)
+    {
+        return FALSE;
+    }
+
+    if (p < eol && *p == ':')
+    {
+        p++;
+    }
+
+    *no = 0;
+
+    for(;;)
+    {
+        p = SkipSpace(p, eol);
+
+        if (p == eol)
+        {
+            break;
+        }
+
+        if (*no == MAX_TRACE_BYTES || p + 1 >= eol ||
+            hex_value[p[0]] < 0 || hex_value[p[1]] < 0)
+        {
+            return FALSE;
+        }
+
+        data[(*no)++] = (byte)(hex_value[p[0]] << 4 | hex_value[p[1]]);
+        p += 2;
+    }
+
+    return *no > 0;
+}
+
+static ulong Hash(word address, const byte *data, int no)
+{
+    ulong h = FNV_OFFSET;
+    int f;
+
+    h = ((h ^ (address & 0xff)) * FNV_PRIME) & 0xfffffffful;
+    h = ((h ^ (address >> 8 & 0xff)) * FNV_PRIME) & 0xfffffffful;
+    h = ((h ^ (address >> 16)) * FNV_PRIME) & 0xfffffffful;
+
+    for(f = 0; f < no; f++)
+    {
+        h = ((h ^ data[f]) * FNV_PRIME) & 0xfffffffful;
+    }
+
+    return (h ^ h >> CACHE_BITS) & (CACHE_SIZE - 1);
+}
+
+/* Disassembles one step, writing it to stdout and, if it is short enough,
+   into the cache entry.
+*/
+static void Render(const CPU *cpu, entry_t *e, word address,
+                   const byte *data, int no)
+{
+    char line[MAX_CACHED_LINE];
+    input_t input;
+    size_t len;
+
+    OutputCapture(line, sizeof line);
+    InputInit(&input, data, (ulong)no);
+    cpu->disassemble(&input, address);
+    len = OutputCaptured();
+    OutputCapture(NULL, 0);
+
+    if (len < sizeof line)
+    {
+        e->address = address;
+        e->no = (byte)no;
+        e->len = (byte)len;
+        memcpy(e->data, data, (size_t)no);
+        memcpy(e->line, line, len);
+        fwrite(line, 1, len, stdout);
+    }
+    else
+    {
+        /* Too long to keep, so let it go straight to stdout
+        */
+        e->no = 0;
+        InputInit(&input, data, (ulong)no);
+        cpu->disassemble(&input, address);
+    }
+}
+
+
+/* ---------------------------------------- INTERFACES
+*/
+int Trace(const CPU *cpu, const byte *trace, ulong size)
+{
+    const byte *p = trace;
+    const byte *end = trace + size;
+    word mask = (word)((1UL << (cpu->digits * 4)) - 1);
+    entry_t *cache;
+    ulong line_no = 1;
+
+    if (!(cache = calloc(CACHE_SIZE, sizeof *cache)))
+    {
+        fprintf(stderr, "dasm: out of memory\n");
+        return FALSE;
+    }
+
+
+    while(p < end)
+    {
+        const byte *eol = memchr(p, '\n', (size_t)(end - p));
+        const byte *s;
+        byte data[MAX_TRACE_BYTES];
+        word address;
+        int no;
+
+        if (!eol)
+        {
+            eol = end;
+        }
+
+        s = SkipSpace(p, eol);
+
+        if (s != eol)
+        {
+            entry_t *e;
+
+            if (!ParseLine(s, eol, mask, &address, data, &no))
+            {
+                fprintf(stderr, "dasm: bad trace: line %lu\n", line_no);
+                free(cache);
+                return FALSE;
+            }
+
+            e = cache + Hash(address, data, no);
+
+            if (e->no == no && e->address == address &&
+                memcmp(e->data, data, (size_t)no) == 0)
+            {
+                fwrite(e->line, 1, e->len, stdout);
+            }
+            else
+            {
+                Render(cpu, e, address, data, no);
+            }
+        }
+
+        p = eol + 1;
+        line_no++;
+    }
+
+    free(cache);
+
+    return TRUE;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,42 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Execution trace disassembly.
+
+*/
+
+#ifndef DASM_TRACE_H
+#define DASM_TRACE_H
+
+#include "global.h"
+#include "decode.h"
+
+/* Disassembles an execution trace.  Each line of the trace is a hex address,
+   optionally followed by a colon, and then the hex bytes of the instruction
+   executed there.  Returns FALSE after reporting an error.
+*/
+int Trace(const CPU *cpu, const byte *trace, ulong size);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,143 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Small helpers shared by the modules.
+
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "util.h"
+
+
+/* ---------------------------------------- GLOBALS
+*/
+const signed char hex_value[256] =
+{
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+
+/* ---------------------------------------- INTERFACES
+*/
+void *Alloc(void *p, size_t size)
+{
+    p = realloc(p, size ? size : 1);
+
+    if (!p)
+    {
+        fprintf(stderr, "dasm: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return p;
+}
+
+void *AllocClear(size_t size)
+{
+    return memset(Alloc(NULL, size), 0, size);
+}
+
+char *CopyString(const char *s)
+{
+    return strcpy(Alloc(NULL, strlen(s) + 1), s);
+}
+
+void CopyName(char *dest, size_t size, const char *src)
+{
+    size_t len = strlen(src);
+
+    if (len > size - 1)
+    {
+        len = size - 1;
+    }
+
+    memcpy(dest, src, len);
+    dest[len] = 0;
+}
+
+ulong Get16(const byte *p)
+{
+    return (ulong)p[0] | (ulong)p[1] << 8;
+}
+
+ulong Get32(const byte *p)
+{
+    return Get16(p) | Get16(p + 2) << 16;
+}
+
+void Set32(byte *p, ulong n)
+{
+    p[0] = (byte)(n & 0xff);
+    p[1] = (byte)((n >> 8) & 0xff);
+    p[2] = (byte)((n >> 16) & 0xff);
+    p[3] = (byte)((n >> 24) & 0xff);
+}
+
+void Put16(FILE *fp, ulong n)
+{
+    putc((int)(n & 0xff), fp);
+    putc((int)((n >> 8) & 0xff), fp);
+}
+
+void Put32(FILE *fp, ulong n)
+{
+    byte b[4];
+
+    Set32(b, n);
+    fwrite(b, 1, sizeof b, fp);
+}
+
+word GetWord(const byte *p, int msb)
+{
+    return msb ? (word)(p[0] << 8 | p[1]) : (word)(p[0] | p[1] << 8);
+}
+
+const byte *SkipSpace(const byte *p, const byte *end)
+{
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    {
+        p++;
+    }
+
+    return p;
+}
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -0,0 +1,75 @@
+/*
+
+    dasm - Simple, portable disassembler
+
+    Copyright (C) 2025  Ian Cowburn (ianc@noddybox.co.uk)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+    -------------------------------------------------------------------------
+
+    Small helpers shared by the modules: memory that cannot run out,
+    little-endian numbers in files and hex digits in text.
+
+*/
+
+#ifndef DASM_UTIL_H
+#define DASM_UTIL_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "global.h"
+
+/* The value of each hex digit character, or -1
+*/
+extern const signed char hex_value[256];
+
+/* Resizes p to size bytes, or allocates it if p is NULL.  AllocClear()
+   allocates size bytes set to zero.  Both exit if memory runs out.
+*/
+void *Alloc(void *p, size_t size);
+void *AllocClear(size_t size);
+
+/* Returns an allocated copy of s
+*/
+char *CopyString(const char *s);
+
+/* Copies the NUL terminated src to dest of size bytes, cutting it short
+   if needed so that it is always terminated
+*/
+void CopyName(char *dest, size_t size, const char *src);
+
+/* Reads and writes little-endian numbers
+*/
+ulong Get16(const byte *p);
+ulong Get32(const byte *p);
+void Set32(byte *p, ulong n);
+void Put16(FILE *fp, ulong n);
+void Put32(FILE *fp, ulong n);
+
+/* Reads a 16-bit word most significant byte first if msb is set, as a
+   processor of that byte order would
+*/
+word GetWord(const byte *p, int msb);
+
+/* Returns the first character from p that is not a space, tab or carriage
+   return, or end
+*/
+const byte *SkipSpace(const byte *p, const byte *end);
+
+#endif
+
+/*
+vim: ai sw=4 ts=8 expandtab
+*/
@@ -28,6 +28,7 @@
 #include <string.h>
 
 #include "z80.h"
+#include "decode.h"
 #include "output.h"
 #include "input.h"
 #include "memory.h"
@@ -124,7 +125,7 @@ static const char *bli[][4] =
 };
 
 static const char *GetIndex(const char *reg, IXYShift ixy_shift,
-                            FILE *input, word *address, memory_t *mem)
+                            input_t *input, word *address, memory_t *mem)
 {
     static char buff[128];
 
@@ -207,7 +208,7 @@ static const char *GetRegPair(const char *reg, IXYShift ixy_shift)
 }
 
 static void DecodeSingleByteWithIXY(word x, word y, word z, word p, word q,
-                                    IXYShift ixy_shift, FILE *input,
+                                    IXYShift ixy_shift, input_t *input,
                                     memory_t *mem, word start_address,
                                     word *address)
 {
@@ -495,7 +496,7 @@ static void DecodeSingleByteWithIXY(word x, word y, word z, word p, word q,
 }
 
 static void DecodeCBByte(word x, word y, word z, word p, word q,
-                         IXYShift ixy_shift, int offset, FILE *input,
+                         IXYShift ixy_shift, int offset, input_t *input,
                          memory_t *mem, word start_address,
                          word *address)
 {
@@ -575,7 +576,7 @@ static void DecodeCBByte(word x, word y, word z, word p, word q,
 }
 
 static void DecodeEDByte(word x, word y, word z, word p, word q,
-                         IXYShift ixy_shift, FILE *input,
+                         IXYShift ixy_shift, input_t *input,
                          memory_t *mem, word start_address,
                          word *address)
 {
@@ -683,7 +684,498 @@ static void DecodeEDByte(word x, word y, word z, word p, word q,
     }
 }
 
-word Z80_Disassemble(FILE *input, word address)
+/* T-states for the unprefixed opcodes.  Conditional jumps and returns are
+   given their shortest time, and the prefixes the four T-states of their
+   fetch.
+*/
+static const byte cycletable[256] =
+{
+    /* 00 */  4, 10,  7,  6,  4,  4,  7,  4,
+    /* 08 */  4, 11,  7,  6,  4,  4,  7,  4,
+    /* 10 */  8, 10,  7,  6,  4,  4,  7,  4,
+    /* 18 */ 12, 11,  7,  6,  4,  4,  7,  4,
+    /* 20 */  7, 10, 16,  6,  4,  4,  7,  4,
+    /* 28 */  7, 11, 16,  6,  4,  4,  7,  4,
+    /* 30 */  7, 10, 13,  6, 11, 11, 10,  4,
+    /* 38 */  7, 11, 13,  6,  4,  4,  7,  4,
+    /* 40 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 48 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 50 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 58 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 60 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 68 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 70 */  7,  7,  7,  7,  7,  7,  4,  7,
+    /* 78 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 80 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 88 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 90 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* 98 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* a0 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* a8 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* b0 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* b8 */  4,  4,  4,  4,  4,  4,  7,  4,
+    /* c0 */  5, 10, 10, 10, 10, 11,  7, 11,
+    /* c8 */  5, 10, 10,  4, 10, 17,  7, 11,
+    /* d0 */  5, 10, 10, 11, 10, 11,  7, 11,
+    /* d8 */  5,  4, 10, 11, 10,  4,  7, 11,
+    /* e0 */  5, 10, 10, 19, 10, 11,  7, 11,
+    /* e8 */  5,  4, 10,  4, 10,  4,  7, 11,
+    /* f0 */  5, 10, 10,  4, 10, 11,  7, 11,
+    /* f8 */  5,  6, 10,  4, 10,  4,  7, 11
+};
+
+/* Most common instructions in typical code, most frequent first
+*/
+const word Z80_Model[] =
+{
+    0x3e, 0xcd, 0xc9, 0x21, 0x18, 0x28, 0x20, 0x7e,
+    0x23, 0x77, 0xfe, 0x32, 0x3a, 0x11, 0xc3, 0xe5,
+    0xe1, 0xc5, 0xc1, 0x01, 0xd5, 0xd1, 0x10, 0xaf,
+    0xb7, 0x06, 0x0e, 0xf5, 0xf1, 0x19, 0x2b, 0x47,
+    0x4f, 0x78, 0x79, 0x7d, 0x7c, 0x6f, 0x67, 0xeb,
+    0x36, 0x13, 0xc8, 0xc0, 0x38, 0x30, 0xca, 0xc2,
+    0xe6, 0x3c, 0x3d, 0x05, 0x0d, 0x12, 0x1a, 0x2a,
+    0x22, 0x09, 0xa7, 0x5f, 0x57, 0x7a, 0x7b, 0x5e,
+    0x56, 0x4e, 0x46, 0x70, 0x71, 0x72, 0x73, 0x16,
+    0x1e, 0x26, 0x2e, 0xd8, 0xd0, 0xf6, 0xc6, 0xd6,
+    0xbe, 0xb8, 0xb9, 0x03, 0x0b, 0x1b, 0x34, 0x35,
+    0x04, 0x0c, 0x14, 0x15, 0x1c, 0x1d, 0x24, 0x25,
+    0xf3, 0xfb, 0xd9, 0x08, 0xe9, 0xf9, 0xee, 0x2f,
+    0x37, 0x3f, 0x07, 0x0f, 0x17, 0x1f, 0x00,
+    eZ80ED << 8 | 0xb0, eZ80ED << 8 | 0x52, eZ80ED << 8 | 0x5b,
+    eZ80ED << 8 | 0x53, eZ80ED << 8 | 0x4b, eZ80ED << 8 | 0x43,
+    eZ80ED << 8 | 0x42, eZ80ED << 8 | 0xb8, eZ80ED << 8 | 0xa0,
+    eZ80ED << 8 | 0x44, eZ80ED << 8 | 0x73, eZ80ED << 8 | 0x7b,
+    eZ80CB << 8 | 0x7e, eZ80CB << 8 | 0x46, eZ80CB << 8 | 0x3f,
+    eZ80CB << 8 | 0x27, eZ80CB << 8 | 0x13, eZ80CB << 8 | 0x12,
+    eZ80DD << 8 | 0x7e, eZ80DD << 8 | 0x77, eZ80DD << 8 | 0x21,
+    eZ80DD << 8 | 0xe5, eZ80DD << 8 | 0xe1, eZ80DD << 8 | 0x36,
+    eZ80FD << 8 | 0x7e, eZ80FD << 8 | 0x77, eZ80FD << 8 | 0x21,
+    eZ80DDCB << 8 | 0x46, eZ80FDCB << 8 | 0x46,
+    MODEL_END
+};
+
+/* Returns TRUE if an IX/IY prefix changes the meaning of the unprefixed
+   opcode, and sets *undocumented if it does so through IXH/IXL/IYH/IYL.
+*/
+static int IndexAffects(word x, word y, word z, word p, word q,
+                        int *undocumented)
+{
+    int hy = (y == 4 || y == 5);
+    int hz = (z == 4 || z == 5);
+
+    *undocumented = FALSE;
+
+    switch(x)
+    {
+        case 0:
+            if (z >= 4 && z <= 6)
+            {
+                *undocumented = hy;
+                return hy || y == 6;
+            }
+
+            return (z == 1 && (q == 1 || p == 2)) ||
+                   ((z == 2 || z == 3) && p == 2);
+
+        case 1:
+            if (y == 6 && z == 6)
+            {
+                return FALSE;
+            }
+
+            *undocumented = (hy && z != 6) || (hz && y != 6);
+            return hy || hz || y == 6 || z == 6;
+
+        case 2:
+            *undocumented = hz;
+            return hz || z == 6;
+
+        default:
+            return (z == 1 && p >= 2) ||
+                   (z == 3 && y == 4) ||
+                   (z == 5 && q == 0 && p == 2);
+    }
+}
+
+/* Returns the flow class of an unprefixed or index prefixed opcode with
+   x == 3.
+*/
+static flow_t Z80Flow(word y, word z, word p, word q, int *conditional)
+{
+    switch(z)
+    {
+        case 0:
+            *conditional = TRUE;
+            return eFlowReturn;
+
+        case 1:
+            if (q == 1 && p == 0)
+            {
+                return eFlowReturn;
+            }
+
+            return q == 1 && p == 2 ? eFlowIndirect : eFlowNext;
+
+        case 2:
+            return eFlowBranch;
+
+        case 3:
+            return y == 0 ? eFlowJump : eFlowNext;
+
+        case 4:
+            *conditional = TRUE;
+            return eFlowCall;
+
+        case 5:
+            return q == 1 && p == 0 ? eFlowCall : eFlowNext;
+
+        case 7:
+            return eFlowCall;
+
+        default:
+            return eFlowNext;
+    }
+}
+
+/* Returns the fewest T-states for a decoded opcode, setting max to the most
+*/
+static int Z80Cycles(int page, byte opcode, word x, word y, word z,
+                     int prefixes, int *max)
+{
+    int cycles;
+
+    switch(page)
+    {
+        case eZ80CB:
+            cycles = z != 6 ? 8 : (x == 1 ? 12 : 15);
+            break;
+
+        case eZ80DDCB:
+        case eZ80FDCB:
+            cycles = (x == 1 ? 20 : 23) + (prefixes - 1) * 4;
+            break;
+
+        case eZ80ED:
+            if (x == 1)
+            {
+                static const byte ed[8] = {12, 12, 15, 20, 8, 14, 8, 0};
+
+                cycles = z != 7 ? ed[z] : (y < 4 ? 9 : y < 6 ? 18 : 8);
+            }
+            else if (x == 2 && z <= 3 && y >= 4)
+            {
+                cycles = 16;
+                *max = y >= 6 ? 21 : 16;
+                return cycles + prefixes * 4;
+            }
+            else
+            {
+                cycles = 8;
+            }
+
+            cycles += prefixes * 4;
+            break;
+
+        default:
+            cycles = cycletable[opcode] + prefixes * 4;
+
+            /* Index prefixed instructions that use (ix+d) for (hl)
+            */
+            if (prefixes && ((x == 0 && z >= 4 && z <= 6 && y == 6) ||
+                             (x == 1 && (y == 6) != (z == 6)) ||
+                             (x == 2 && z == 6)))
+            {
+                cycles += opcode == 0x36 ? 5 : 8;
+            }
+
+            if (x == 0 && z == 0 && y >= 2 && y != 3)
+            {
+                *max = cycles + 5;
+                return cycles;
+            }
+
+            if (x == 3 && (z == 0 || z == 4))
+            {
+                *max = cycles + (z == 0 ? 6 : 7);
+                return cycles;
+            }
+            break;
+    }
+
+    *max = cycles;
+
+    return cycles;
+}
+
+int Z80_Decode(const byte *data, ulong size, word address, decode_t *decode)
+{
+    IXYShift ixy_shift = eNone;
+    int cb_shift = 0;
+    int ed_shift = 0;
+    int prefixes = 0;
+    int undocumented = FALSE;
+    int illegal = FALSE;
+    int index;
+    int extra = 0;
+    int immediate = 0;
+    ulong n = 0;
+    ulong length;
+    byte opcode;
+    word x,y,z,p,q;
+
+    /* Mirror the prefix handling of Z80_Disassemble()
+    */
+    for(;;)
+    {
+        if (n >= size)
+        {
+            return 0;
+        }
+
+        opcode = data[n++];
+
+        if (cb_shift || ed_shift)
+        {
+            break;
+        }
+        else if (opcode == 0xcb)
+        {
+            cb_shift = 1;
+        }
+        else if (opcode == 0xed)
+        {
+            ed_shift = 1;
+        }
+        else if (opcode == 0xdd)
+        {
+            ixy_shift = eIX;
+            prefixes++;
+        }
+        else if (opcode == 0xfd)
+        {
+            ixy_shift = eIY;
+            prefixes++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (cb_shift && ixy_shift != eNone)
+    {
+        if (n >= size)
+        {
+            return 0;
+        }
+
+        opcode = data[n++];
+    }
+
+    x = (opcode & 0xc0) >> 6;
+    y = (opcode & 0x38) >> 3;
+    z = (opcode & 0x07);
+    p = y >> 1;
+    q = y & 1;
+
+    index = ixy_shift != eNone;
+
+    decode->address = address;
+    decode->opcode = opcode;
+    decode->flow = eFlowNext;
+    decode->conditional = FALSE;
+    decode->has_target = FALSE;
+    decode->target = 0;
+
+    if (cb_shift)
+    {
+        if (index)
+        {
+            decode->page = ixy_shift == eIX ? eZ80DDCB : eZ80FDCB;
+            illegal = z != 6 || (x == 0 && y == 6);
+        }
+        else
+        {
+            decode->page = eZ80CB;
+            illegal = x == 0 && y == 6;
+        }
+    }
+    else if (ed_shift)
+    {
+        decode->page = eZ80ED;
+
+        switch(x)
+        {
+            case 1:
+                extra = immediate = z == 3 ? 2 : 0;
+                decode->flow = z == 5 ? eFlowReturn : eFlowNext;
+                illegal = ((z == 0 || z == 1) && y == 6) ||
+                          (z == 4 && y != 0) ||
+                          (z == 5 && y > 1) ||
+                          (z == 6 && (y == 1 || y >= 4)) ||
+                          (z == 7 && y >= 6);
+                break;
+
+            case 2:
+                illegal = !(z <= 3 && y >= 4);
+                break;
+
+            default:
+                illegal = TRUE;
+                break;
+        }
+
+        illegal |= index;
+    }
+    else
+    {
+        decode->page = index ? (ixy_shift == eIX ? eZ80DD : eZ80FD)
+                             : eZ80Main;
+
+        if (index)
+        {
+            illegal = !IndexAffects(x, y, z, p, q, &undocumented) ||
+                        undocumented;
+        }
+
+        switch(x)
+        {
+            case 0:
+                if (z == 0 && y >= 2)
+                {
+                    extra = 1;
+                    decode->flow = y == 3 ? eFlowJump : eFlowBranch;
+
+                    if (n < size)
+                    {
+                        decode->has_target = TRUE;
+                        decode->target = (address + n + 1 +
+                                                (relative)data[n]) & 0xffff;
+                    }
+                }
+                else if ((z == 1 && q == 0) || (z == 2 && p >= 2))
+                {
+                    extra = immediate = 2;
+                }
+                else if (z == 4 || z == 5)
+                {
+                    extra = y == 6 && index;
+                }
+                else if (z == 6)
+                {
+                    extra = 1 + (y == 6 && index);
+                    immediate = 1;
+                }
+                break;
+
+            case 1:
+                extra = index && (y == 6) != (z == 6);
+
+                if (y == 6 && z == 6)
+                {
+                    decode->flow = eFlowHalt;
+                }
+                break;
+
+            case 2:
+                extra = index && z == 6;
+                break;
+
+            case 3:
+                decode->flow = Z80Flow(y, z, p, q, &decode->conditional);
+
+                if (z == 2 || z == 4 || (z == 3 && y == 0) ||
+                    (z == 5 && q == 1 && p == 0))
+                {
+                    extra = 2;
+
+                    if (n + 1 < size)
+                    {
+                        decode->has_target = TRUE;
+                        decode->target = data[n] | data[n + 1] << 8;
+                    }
+                }
+                else if (z == 6 || (z == 3 && (y == 2 || y == 3)))
+                {
+                    extra = immediate = 1;
+                }
+                else if (z == 7)
+                {
+                    decode->has_target = TRUE;
+                    decode->target = y * 8;
+                }
+                break;
+        }
+    }
+
+    length = n + extra;
+
+    if (length > size)
+    {
+        return 0;
+    }
+
+    /* Immediate values and addresses always end the instruction
+    */
+    decode->has_operand = decode->has_target || immediate;
+
+    if (decode->has_target)
+    {
+        decode->operand = decode->target;
+    }
+    else if (immediate == 2)
+    {
+        decode->operand = data[length - 2] | data[length - 1] << 8;
+    }
+    else
+    {
+        decode->operand = immediate ? data[length - 1] : 0;
+    }
+
+    decode->length = (int)length;
+    decode->illegal = illegal || prefixes > 1;
+    decode->cycles = Z80Cycles(decode->page, opcode, x, y, z, prefixes,
+                               &decode->cycles_max);
+
+    return (int)length;
+}
+
+int Z80_Entries(const byte *data, ulong size, word origin,
+                word *entry, int max)
+{
+    int no = 0;
+    word vec;
+
+    (void)data;
+
+    if (no < max)
+    {
+        entry[no++] = origin;
+    }
+
+    /* The restart and NMI vectors if this looks like a ROM at zero
+    */
+    if (origin == 0)
+    {
+        for(vec = 0x08; vec <= 0x66 && no < max; vec += 8)
+        {
+            if (vec > 0x38)
+            {
+                vec = 0x66;
+            }
+
+            if (vec < size)
+            {
+                entry[no++] = vec;
+            }
+        }
+    }
+
+    return no;
+}
+
+word Z80_Disassemble(input_t *input, word address)
 {
     memory_t mem = INIT_MEMORY;
     word x,y,z,p,q;
@@ -699,7 +1191,7 @@ word Z80_Disassemble(FILE *input, word address)
 get_opcode:
     opcode = GetByte(input, &address, &mem);
 
-    if (feof(input))
+    if (InputEOF(input))
     {
         return start_address;
     }
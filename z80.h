@@ -26,10 +26,30 @@
 #ifndef DASM_Z80_H
 #define DASM_Z80_H
 
-#include <stdio.h>
 #include "global.h"
+#include "input.h"
+#include "decode.h"
 
-word Z80_Disassemble(FILE *input, word address);
+/* Opcode pages as reported in decode_t
+*/
+typedef enum
+{
+    eZ80Main,
+    eZ80CB,
+    eZ80ED,
+    eZ80DD,
+    eZ80FD,
+    eZ80DDCB,
+    eZ80FDCB,
+    eZ80Pages
+} z80_page_t;
+
+word Z80_Disassemble(input_t *input, word address);
+int Z80_Decode(const byte *data, ulong size, word address, decode_t *decode);
+int Z80_Entries(const byte *data, ulong size, word origin,
+                word *entry, int max);
+
+extern const word Z80_Model[];
 
 #endif
 